@@ -0,0 +1,98 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+SPACES_BEGIN_NAMESPACE
+
+using std::experimental::default_accessor;
+
+// `is_sufficiently_aligned<N>(p)` - True if `p` is aligned to `N` bytes.
+template <std::size_t N, typename T>
+bool is_sufficiently_aligned(T* p) noexcept
+{
+  return reinterpret_cast<std::uintptr_t>(p) % N == 0;
+}
+
+// `aligned_accessor<T, N>` - An `mdspan` accessor policy like
+// `default_accessor<T>`, except that the data handle is known to be aligned
+// to `N` bytes. Every access tells the compiler so, the way
+// `SPACES_ASSUME_ALIGNED` does for raw pointers, so an `mdspan` carries its
+// alignment in its type.
+//
+// Only the data handle is aligned, not every element, so `offset` (which
+// `submdspan` uses) returns a `default_accessor` handle. Converting from a
+// `default_accessor` is explicit, as the alignment can't be checked without
+// the data handle; use `aligned_cast` to convert an `mdspan`.
+template <typename T, std::size_t N>
+struct aligned_accessor
+{
+  static_assert(std::has_single_bit(N), "The alignment must be a power of 2.");
+  static_assert(
+    N >= alignof(T)
+  , "The alignment must be at least the alignment of the element type."
+  );
+
+  using offset_policy = default_accessor<T>;
+  using element_type = T;
+  using reference = T&;
+  using data_handle_type = T*;
+
+  static constexpr std::size_t byte_alignment = N;
+
+  constexpr aligned_accessor() noexcept = default;
+
+  template <typename U, std::size_t M>
+    requires(std::convertible_to<U(*)[], T(*)[]> && M >= N)
+  constexpr aligned_accessor(aligned_accessor<U, M>) noexcept {}
+
+  template <typename U>
+    requires(std::convertible_to<U(*)[], T(*)[]>)
+  explicit constexpr aligned_accessor(default_accessor<U>) noexcept {}
+
+  template <typename U>
+    requires(std::convertible_to<T(*)[], U(*)[]>)
+  constexpr operator default_accessor<U>() const noexcept { return {}; }
+
+  constexpr data_handle_type offset(data_handle_type p, std::size_t i)
+    const noexcept
+  {
+    return p + i;
+  }
+
+  constexpr reference access(data_handle_type p, std::size_t i) const noexcept
+  {
+    return std::assume_aligned<N>(p)[i];
+  }
+};
+
+// `aligned_cast<N>(A)` - `A`, an `mdspan` with a `default_accessor`, as an
+// `mdspan` with an `aligned_accessor` of alignment `N`. Its data handle must
+// be aligned to `N` bytes. That's checked in every build, as the accesses that
+// assume it would silently misbehave: if it isn't, the program is aborted.
+template <std::size_t N, typename T, typename Extents, typename Layout>
+constexpr auto aligned_cast(
+  mdspan<T, Extents, Layout, default_accessor<T>> const& A
+  ) noexcept
+{
+  if (!is_sufficiently_aligned<N>(A.data_handle())) std::abort();
+  using R = mdspan<T, Extents, Layout, aligned_accessor<T, N>>;
+  return R(A.data_handle(), A.mapping(), aligned_accessor<T, N>(A.accessor()));
+}
+
+SPACES_END_NAMESPACE
+
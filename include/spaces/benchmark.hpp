@@ -0,0 +1,849 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+#include <spaces/performance_counters.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// SPACES_BENCHMARK_COMPILER - String literal identifying the compiler, recorded
+// in machine-readable benchmark results.
+#if !defined(SPACES_BENCHMARK_COMPILER)
+  #if   defined(__clang__)
+    #define SPACES_BENCHMARK_COMPILER "Clang " __clang_version__
+  #elif defined(__GNUC__)
+    #define SPACES_BENCHMARK_COMPILER "GCC " __VERSION__
+  #else
+    #define SPACES_BENCHMARK_COMPILER "unknown"
+  #endif
+#endif
+
+// SPACES_BENCHMARK_FLAGS - String literal containing the flags the benchmark
+// was compiled with. The build system is expected to define this.
+#if !defined(SPACES_BENCHMARK_FLAGS)
+  #define SPACES_BENCHMARK_FLAGS "unknown"
+#endif
+
+SPACES_BEGIN_NAMESPACE
+
+struct benchmark_options
+{
+  // Untimed runs of each kernel before sampling starts.
+  index_type warmup = 3;
+
+  // Timed samples taken for each kernel.
+  index_type repetitions = 31;
+
+  // Each sample runs the kernel back-to-back until at least this many seconds
+  // have passed, so that short kernels aren't lost in timer resolution.
+  double min_sample_time = 1.0e-3;
+
+  // If non-empty, results are also written to this file as JSON.
+  std::string json;
+
+  // If non-empty, results are also written to this file as CSV, one row per
+  // kernel and problem size, for plotting.
+  std::string csv;
+
+  // Collect hardware performance counters during the timed samples.
+  bool counters = false;
+
+  // Raw event encoding for `performance_counter::vector_instructions`; see
+  // `performance_counters`.
+  std::uint64_t vector_event = 0;
+
+  // Problem sizes to run, as the extent of each dimension. If empty and no
+  // sweep was requested, the driver's default size is used.
+  std::vector<index_type> sizes;
+
+  // If `sweep_max_bytes` is non-zero, problem sizes are chosen so that the
+  // footprint of the array doubles from `sweep_min_bytes` up to
+  // `sweep_max_bytes`, covering every level of the memory hierarchy.
+  std::uint64_t sweep_min_bytes = 0;
+  std::uint64_t sweep_max_bytes = 0;
+
+  // If non-zero, kernels whose median time exceeds `max_penalty` times the
+  // reference kernel's median at the same extents are reported as failures.
+  double max_penalty = 0.0;
+
+  // Kernels that `max_penalty` applies to; if empty, it applies to all.
+  std::vector<std::string> penalty_kernels;
+
+  // Kernels that `max_penalty` never applies to.
+  std::vector<std::string> penalty_exempt_kernels;
+
+  // `extents_for(rank, element_size, multiple, default_size)` - Returns the
+  // extent of each dimension of every problem size to run for a rank `rank`
+  // array of `element_size` byte elements: `sizes` if given; otherwise, if a
+  // sweep was requested, the largest multiple of `multiple` whose footprint
+  // doesn't exceed each step of the sweep; otherwise `{default_size}`.
+  std::vector<index_type> extents_for(
+    index_type rank
+  , index_type element_size
+  , index_type multiple
+  , index_type default_size
+  ) const
+  {
+    if (!sizes.empty()) return sizes;
+    if (sweep_max_bytes == 0) return {default_size};
+
+    std::vector<index_type> extents;
+    for (auto bytes = std::max<std::uint64_t>(sweep_min_bytes, element_size);
+         bytes <= sweep_max_bytes; bytes *= 2)
+    {
+      auto n = index_type(std::pow(double(bytes / element_size), 1.0 / rank));
+      // Guard against `pow` rounding just below an exact root.
+      while (std::pow(double(n + 1), double(rank)) * element_size <= bytes) ++n;
+      n = std::max(multiple, n / multiple * multiple);
+      if (extents.empty() || extents.back() != n) extents.push_back(n);
+    }
+    return extents;
+  }
+};
+
+// `parse_benchmark_options(argc, argv)` - Builds `benchmark_options` from
+// `--warmup=N`, `--repetitions=N`, `--min-sample-time=SECONDS`,
+// `--json=FILE`, `--csv=FILE`, `--counters`, `--vector-event=CODE`,
+// `--sizes=N,N,...`, `--sweep[=MIN,MAX]`, `--max-penalty=RATIO`,
+// `--penalty-kernels=NAME,NAME,...` and
+// `--penalty-exempt-kernels=NAME,NAME,...` arguments. Sweep bounds are in
+// bytes and take `K`, `M` and `G` (binary) suffixes; `--sweep` alone is
+// `--sweep=16K,1G`. Unknown arguments are ignored so that drivers can add
+// their own.
+inline benchmark_options parse_benchmark_options(int argc, char** argv)
+{
+  benchmark_options options;
+
+  auto value_of = [] (std::string_view arg, std::string_view flag)
+                  -> char const*
+  {
+    if (arg.size() > flag.size() && arg.starts_with(flag)
+     && arg[flag.size()] == '=')
+      return arg.data() + flag.size() + 1;
+    return nullptr;
+  };
+
+  auto for_each_item = [] (char const* list, auto&& f)
+  {
+    std::string_view rest = list;
+    while (!rest.empty()) {
+      auto const comma = rest.find(',');
+      auto const item = rest.substr(0, comma);
+      if (!item.empty()) f(std::string(item));
+      if (comma == std::string_view::npos) break;
+      rest.remove_prefix(comma + 1);
+    }
+  };
+
+  auto bytes_of = [] (std::string const& item) -> std::uint64_t
+  {
+    char* suffix = nullptr;
+    std::uint64_t bytes = std::strtoull(item.c_str(), &suffix, 10);
+    switch (*suffix) {
+      case 'G': case 'g': bytes <<= 10; [[fallthrough]];
+      case 'M': case 'm': bytes <<= 10; [[fallthrough]];
+      case 'K': case 'k': bytes <<= 10;
+    }
+    return bytes;
+  };
+
+  for (int i = 1; i < argc; ++i) {
+    if (auto v = value_of(argv[i], "--warmup"))
+      options.warmup = std::strtoull(v, nullptr, 10);
+    else if (auto v = value_of(argv[i], "--repetitions"))
+      options.repetitions = std::max(std::strtoull(v, nullptr, 10), 1ULL);
+    else if (auto v = value_of(argv[i], "--min-sample-time"))
+      options.min_sample_time = std::strtod(v, nullptr);
+    else if (auto v = value_of(argv[i], "--json"))
+      options.json = v;
+    else if (auto v = value_of(argv[i], "--csv"))
+      options.csv = v;
+    else if (std::string_view(argv[i]) == "--counters")
+      options.counters = true;
+    else if (auto v = value_of(argv[i], "--vector-event")) {
+      options.counters = true;
+      options.vector_event = std::strtoull(v, nullptr, 0);
+    }
+    else if (auto v = value_of(argv[i], "--sizes"))
+      for_each_item(v, [&] (std::string item) {
+        options.sizes.push_back(std::strtoull(item.c_str(), nullptr, 10));
+      });
+    else if (std::string_view(argv[i]) == "--sweep") {
+      options.sweep_min_bytes = 16ULL << 10;
+      options.sweep_max_bytes = 1ULL << 30;
+    }
+    else if (auto v = value_of(argv[i], "--sweep")) {
+      std::vector<std::uint64_t> bounds;
+      for_each_item(v, [&] (std::string item) {
+        bounds.push_back(bytes_of(item));
+      });
+      if (bounds.size() == 2) {
+        options.sweep_min_bytes = bounds[0];
+        options.sweep_max_bytes = bounds[1];
+      }
+    }
+    else if (auto v = value_of(argv[i], "--max-penalty"))
+      options.max_penalty = std::strtod(v, nullptr);
+    else if (auto v = value_of(argv[i], "--penalty-kernels"))
+      for_each_item(v, [&] (std::string item) {
+        options.penalty_kernels.push_back(std::move(item));
+      });
+    else if (auto v = value_of(argv[i], "--penalty-exempt-kernels"))
+      for_each_item(v, [&] (std::string item) {
+        options.penalty_exempt_kernels.push_back(std::move(item));
+      });
+  }
+
+  return options;
+}
+
+// All times are in seconds per kernel invocation.
+struct benchmark_statistics
+{
+  double median = 0.0;
+  double min    = 0.0;
+  double max    = 0.0;
+  double mean   = 0.0;
+  double stddev = 0.0;
+};
+
+inline benchmark_statistics compute_statistics(std::vector<double> samples)
+{
+  benchmark_statistics s;
+
+  if (samples.empty())
+    return s;
+
+  std::sort(samples.begin(), samples.end());
+
+  auto const n = samples.size();
+
+  s.min    = samples.front();
+  s.max    = samples.back();
+  s.median = (n % 2) ? samples[n / 2]
+                     : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+
+  double sum = 0.0;
+  for (double x : samples) sum += x;
+  s.mean = sum / n;
+
+  double sq = 0.0;
+  for (double x : samples) sq += (x - s.mean) * (x - s.mean);
+  s.stddev = (n > 1) ? std::sqrt(sq / (n - 1)) : 0.0;
+
+  return s;
+}
+
+struct benchmark_result
+{
+  std::string kernel;
+
+  // The kernel this one is compared against. If empty, the reference passed
+  // to the reporting functions is used.
+  std::string reference;
+
+  // Extents of the problem the kernel was run on.
+  std::vector<index_type> extents;
+
+  // Bytes of memory traffic one invocation of the kernel is expected to
+  // generate; used to derive throughput.
+  std::uint64_t bytes = 0;
+
+  // Seconds per invocation, one entry per sample.
+  std::vector<double> samples;
+
+  benchmark_statistics time;
+
+  // Hardware counts per invocation; NaN if not collected or unavailable.
+  performance_counter_values counters = []
+  {
+    performance_counter_values v;
+    v.fill(std::numeric_limits<double>::quiet_NaN());
+    return v;
+  }();
+
+  // Whether any hardware performance counter could be opened for the samples.
+  bool counters_available = false;
+};
+
+// `benchmark_batch_size(reset, kernel, options)` - Runs the warm-up
+// invocations of `kernel()` and returns how many back-to-back invocations it
+// takes to fill `options.min_sample_time`.
+template <typename Reset, typename Kernel>
+index_type benchmark_batch_size(
+  Reset&& reset
+, Kernel&& kernel
+, benchmark_options const& options
+  )
+{
+  using clock = std::chrono::steady_clock;
+
+  for (index_type w = 0; w != options.warmup; ++w) {
+    reset();
+    kernel();
+  }
+
+  index_type batch = 1;
+  while (true) {
+    reset();
+    auto const start = clock::now();
+    for (index_type b = 0; b != batch; ++b) kernel();
+    std::chrono::duration<double> const elapsed = clock::now() - start;
+    if (elapsed.count() >= options.min_sample_time || batch >= (1ULL << 30))
+      return batch;
+    batch *= 2;
+  }
+}
+
+// `benchmark_sample(reset, kernel, batch, counters)` - Returns the seconds per
+// invocation of `batch` back-to-back invocations of `kernel()`, preceded by an
+// untimed `reset()`. If `counters` isn't null, it counts the invocations.
+template <typename Reset, typename Kernel>
+double benchmark_sample(
+  Reset&& reset
+, Kernel&& kernel
+, index_type batch
+, performance_counters* counters
+  )
+{
+  using clock = std::chrono::steady_clock;
+
+  reset();
+  if (counters) counters->start();
+  auto const start = clock::now();
+  for (index_type b = 0; b != batch; ++b) kernel();
+  std::chrono::duration<double> const elapsed = clock::now() - start;
+  if (counters) counters->stop();
+  return elapsed.count() / batch;
+}
+
+// `benchmark(name, extents, bytes, reset, kernel, options)` - Times
+// `kernel()`.
+//
+// `reset()` is called (untimed) before each warm-up run and each sample to put
+// the kernel's data back into its initial state. Within a sample, `kernel()`
+// is invoked repeatedly without resets, so it must be idempotent.
+//
+// If `options.counters` is set, hardware performance counters are collected
+// over the timed samples and reported per invocation.
+template <typename Reset, typename Kernel>
+benchmark_result benchmark(
+  std::string name
+, std::vector<index_type> extents
+, std::uint64_t bytes
+, Reset&& reset
+, Kernel&& kernel
+, benchmark_options const& options
+  )
+{
+  index_type const batch = benchmark_batch_size(reset, kernel, options);
+
+  benchmark_result r;
+  r.kernel  = std::move(name);
+  r.extents = std::move(extents);
+  r.bytes   = bytes;
+  r.samples.reserve(options.repetitions);
+
+  // Opening the counters costs a `perf_event_open` per event, so it's only
+  // done if they were asked for.
+  std::unique_ptr<performance_counters> counters;
+  if (options.counters) {
+    counters = std::make_unique<performance_counters>(options.vector_event);
+    if (!counters->any_available()) counters.reset();
+  }
+
+  for (index_type s = 0; s != options.repetitions; ++s)
+    r.samples.push_back(
+      benchmark_sample(reset, kernel, batch, counters.get())
+    );
+
+  r.time = compute_statistics(r.samples);
+
+  if (counters) {
+    r.counters = counters->values(double(options.repetitions * batch));
+    r.counters_available = true;
+  }
+
+  return r;
+}
+
+// `benchmark_kernels(results, kernels, extents, bytes, reset, invoke, options)`
+// - Times `invoke(kernel)` for each `{name, kernel}` element of `kernels` and
+// appends the results to `results`.
+//
+// Unlike calling `benchmark` for each kernel in turn, the samples are taken
+// round-robin, one sample of each kernel per round, so that every kernel sees
+// the same drift in clock frequency and machine load. This keeps the ratios
+// between kernels stable enough to test against.
+template <typename Kernels, typename Reset, typename Invoke>
+void benchmark_kernels(
+  std::vector<benchmark_result>& results
+, Kernels const& kernels
+, std::vector<index_type> const& extents
+, std::uint64_t bytes
+, Reset&& reset
+, Invoke&& invoke
+, benchmark_options const& options
+  )
+{
+  struct state
+  {
+    std::function<void()> run;
+    index_type batch;
+    std::unique_ptr<performance_counters> counters;
+  };
+
+  std::size_t const first = results.size();
+  std::vector<state> states;
+
+  for (auto const& [name, kernel] : kernels) {
+    state st;
+    st.run = [&invoke, kernel] { invoke(kernel); };
+    st.batch = benchmark_batch_size(reset, st.run, options);
+    if (options.counters) {
+      st.counters = std::make_unique<performance_counters>(
+        options.vector_event
+      );
+      if (!st.counters->any_available()) st.counters.reset();
+    }
+    states.push_back(std::move(st));
+
+    benchmark_result r;
+    r.kernel  = name;
+    r.extents = extents;
+    r.bytes   = bytes;
+    r.samples.reserve(options.repetitions);
+    results.push_back(std::move(r));
+  }
+
+  for (index_type s = 0; s != options.repetitions; ++s)
+    for (std::size_t k = 0; k != states.size(); ++k)
+      results[first + k].samples.push_back(benchmark_sample(
+        reset, states[k].run, states[k].batch, states[k].counters.get()
+      ));
+
+  for (std::size_t k = 0; k != states.size(); ++k) {
+    auto& r = results[first + k];
+    r.time = compute_statistics(r.samples);
+    if (states[k].counters) {
+      r.counters = states[k].counters->values(
+        double(options.repetitions * states[k].batch)
+      );
+      r.counters_available = true;
+    }
+  }
+}
+
+// `benchmark_find_reference(results, r, reference)` - Returns the result in
+// `results` for the reference kernel of `r` (`r.reference`, or `reference` if
+// that is empty) at the same extents as `r`, or null if there is none.
+inline benchmark_result const* benchmark_find_reference(
+  std::vector<benchmark_result> const& results
+, benchmark_result const& r
+, std::string_view reference
+  )
+{
+  if (!r.reference.empty()) reference = r.reference;
+  for (auto const& ref : results)
+    if (ref.kernel == reference && ref.extents == r.extents)
+      return &ref;
+  return nullptr;
+}
+
+// `benchmark_extents_string(r)` - Returns the extents of `r` as "NxMx...".
+inline std::string benchmark_extents_string(benchmark_result const& r)
+{
+  std::string e;
+  for (auto x : r.extents) {
+    if (!e.empty()) e += 'x';
+    e += std::to_string(x);
+  }
+  return e;
+}
+
+// `benchmark_report(os, results, reference)` - Prints a table of `results`,
+// with each kernel's median time expressed relative to that of its reference
+// kernel at the same extents (if it is present).
+inline void benchmark_report(
+  std::ostream& os
+, std::vector<benchmark_result> const& results
+, std::string_view reference
+  )
+{
+  auto const reference_median = [&] (benchmark_result const& r)
+  {
+    if (auto const* ref = benchmark_find_reference(results, r, reference))
+      return ref->time.median;
+    return 0.0;
+  };
+
+  auto const extents_of = benchmark_extents_string;
+
+  std::size_t extents_width = std::strlen("extents");
+  for (auto const& r : results)
+    extents_width = std::max(extents_width, extents_of(r).size());
+
+  std::size_t width = std::strlen("kernel");
+  for (auto const& r : results) width = std::max(width, r.kernel.size());
+
+  auto const flags = os.flags();
+  auto const precision = os.precision();
+
+  os << std::left  << std::setw(width) << "kernel"
+     << std::right << std::setw(extents_width + 2) << "extents"
+                   << std::setw(14) << "median [us]"
+                   << std::setw(14) << "min [us]"
+                   << std::setw(14) << "stddev [us]"
+                   << std::setw(12) << "GB/s"
+                   << std::setw(14) << "vs reference"
+     << "\n";
+
+  os << std::fixed;
+
+  for (auto const& r : results) {
+    os << std::left  << std::setw(width) << r.kernel
+       << std::right << std::setw(extents_width + 2) << extents_of(r)
+       << std::setprecision(3)
+       << std::setw(14) << r.time.median * 1.0e6
+       << std::setw(14) << r.time.min * 1.0e6
+       << std::setw(14) << r.time.stddev * 1.0e6
+       << std::setprecision(2);
+    if (r.bytes != 0)
+      os << std::setw(12) << r.bytes / r.time.median * 1.0e-9;
+    else
+      os << std::setw(12) << "n/a";
+    if (auto const ref = reference_median(r); ref > 0.0)
+      os << std::setw(13) << r.time.median / ref << "x";
+    else
+      os << std::setw(14) << "n/a";
+    os << "\n";
+  }
+
+  bool any_counters = false;
+  for (auto const& r : results)
+    for (double c : r.counters)
+      if (!std::isnan(c)) any_counters = true;
+
+  if (any_counters) {
+    os << "\n" << std::left << std::setw(width) << "kernel" << std::right
+       << std::setw(extents_width + 2) << "extents";
+    for (auto name : performance_counter_names)
+      os << std::setw(std::max<std::size_t>(std::strlen(name) + 2, 12))
+         << name;
+    os << std::setw(8) << "IPC" << "\n";
+
+    for (auto const& r : results) {
+      os << std::left << std::setw(width) << r.kernel << std::right
+         << std::setw(extents_width + 2) << extents_of(r)
+         << std::setprecision(1);
+      for (index_type c = 0; c != performance_counter_count; ++c) {
+        auto const w = std::max<std::size_t>(
+          std::strlen(performance_counter_names[c]) + 2, 12
+        );
+        if (std::isnan(r.counters[c])) os << std::setw(w) << "n/a";
+        else                           os << std::setw(w) << r.counters[c];
+      }
+      double const ipc
+        = r.counters[index_type(performance_counter::instructions)]
+        / r.counters[index_type(performance_counter::cycles)];
+      os << std::setprecision(2);
+      if (std::isnan(ipc)) os << std::setw(8) << "n/a";
+      else                 os << std::setw(8) << ipc;
+      os << "\n";
+    }
+  }
+
+  os.flags(flags);
+  os.precision(precision);
+  os << std::flush;
+}
+
+// `benchmark_report_per_element(os, results)` - Prints a table of the cost of
+// each kernel in `results` per element of its extents: time, and cycles and
+// instructions if those counters were collected. Useful for kernels whose
+// per-element work is trivial, where this is the overhead of the iteration.
+inline void benchmark_report_per_element(
+  std::ostream& os
+, std::vector<benchmark_result> const& results
+  )
+{
+  std::size_t extents_width = std::strlen("extents");
+  for (auto const& r : results)
+    extents_width = std::max(
+      extents_width, benchmark_extents_string(r).size()
+    );
+
+  std::size_t width = std::strlen("kernel");
+  for (auto const& r : results) width = std::max(width, r.kernel.size());
+
+  auto const flags = os.flags();
+  auto const precision = os.precision();
+
+  os << std::left  << std::setw(width) << "kernel"
+     << std::right << std::setw(extents_width + 2) << "extents"
+                   << std::setw(16) << "ns/element"
+                   << std::setw(16) << "cycles/element"
+                   << std::setw(22) << "instructions/element"
+     << "\n";
+
+  os << std::fixed << std::setprecision(3);
+
+  for (auto const& r : results) {
+    double elements = 1.0;
+    for (auto x : r.extents) elements *= double(x);
+
+    double const cycles
+      = r.counters[index_type(performance_counter::cycles)] / elements;
+    double const instructions
+      = r.counters[index_type(performance_counter::instructions)] / elements;
+
+    os << std::left  << std::setw(width) << r.kernel
+       << std::right << std::setw(extents_width + 2)
+       << benchmark_extents_string(r)
+       << std::setw(16) << r.time.median * 1.0e9 / elements;
+    if (std::isnan(cycles)) os << std::setw(16) << "n/a";
+    else                    os << std::setw(16) << cycles;
+    if (std::isnan(instructions)) os << std::setw(22) << "n/a";
+    else                          os << std::setw(22) << instructions;
+    os << "\n";
+  }
+
+  os.flags(flags);
+  os.precision(precision);
+  os << std::flush;
+}
+
+inline void benchmark_write_json_string(std::ostream& os, std::string_view str)
+{
+  os << '"';
+  for (char c : str) {
+    if      (c == '"')  os << "\\\"";
+    else if (c == '\\') os << "\\\\";
+    else if (c == '\n') os << "\\n";
+    else                os << c;
+  }
+  os << '"';
+}
+
+// `benchmark_write_json(os, suite, results)` - Writes `results` as a JSON
+// document that `benchmark_compare` can read:
+//
+// {
+//   "suite": "memset_2d",
+//   "compiler": "...",
+//   "flags": "...",
+//   "benchmarks": [
+//     { "kernel": "...", "extents": [...], "bytes": ...,
+//       "median": ..., "min": ..., "max": ..., "mean": ..., "stddev": ...,
+//       "samples": [...], "counters": { "cycles": ..., ... } },
+//     ...
+//   ]
+// }
+//
+// Times are in seconds and counters are counts per kernel invocation.
+// Unavailable counters are `null`.
+inline void benchmark_write_json(
+  std::ostream& os
+, std::string_view suite
+, std::vector<benchmark_result> const& results
+  )
+{
+  auto const flags = os.flags();
+  auto const precision = os.precision();
+
+  os << std::scientific << std::setprecision(9);
+
+  os << "{\n  \"suite\": ";
+  benchmark_write_json_string(os, suite);
+  os << ",\n  \"compiler\": ";
+  benchmark_write_json_string(os, SPACES_BENCHMARK_COMPILER);
+  os << ",\n  \"flags\": ";
+  benchmark_write_json_string(os, SPACES_BENCHMARK_FLAGS);
+  os << ",\n  \"benchmarks\": [";
+
+  for (std::size_t i = 0; i != results.size(); ++i) {
+    auto const& r = results[i];
+
+    os << (i ? ",\n" : "\n") << "    {\"kernel\": ";
+    benchmark_write_json_string(os, r.kernel);
+
+    os << ", \"extents\": [";
+    for (std::size_t e = 0; e != r.extents.size(); ++e)
+      os << (e ? ", " : "") << r.extents[e];
+    os << "]";
+
+    os << ", \"bytes\": "  << r.bytes
+       << ", \"median\": " << r.time.median
+       << ", \"min\": "    << r.time.min
+       << ", \"max\": "    << r.time.max
+       << ", \"mean\": "   << r.time.mean
+       << ", \"stddev\": " << r.time.stddev;
+
+    os << ", \"samples\": [";
+    for (std::size_t s = 0; s != r.samples.size(); ++s)
+      os << (s ? ", " : "") << r.samples[s];
+    os << "]";
+
+    os << ", \"counters\": {";
+    for (index_type c = 0; c != performance_counter_count; ++c) {
+      os << (c ? ", " : "") << "\"" << performance_counter_names[c] << "\": ";
+      if (std::isnan(r.counters[c])) os << "null";
+      else                           os << r.counters[c];
+    }
+    os << "}}";
+  }
+
+  os << "\n  ]\n}\n";
+
+  os.flags(flags);
+  os.precision(precision);
+  os << std::flush;
+}
+
+// `benchmark_write_csv(os, suite, results, reference)` - Writes `results` as
+// CSV with a header row and one row per kernel and extents, suitable for
+// plotting time or bandwidth against problem size. Times are in seconds;
+// `vs_reference` is empty if the reference kernel wasn't run at those extents.
+inline void benchmark_write_csv(
+  std::ostream& os
+, std::string_view suite
+, std::vector<benchmark_result> const& results
+, std::string_view reference
+  )
+{
+  auto const flags = os.flags();
+  auto const precision = os.precision();
+
+  os << "suite,kernel,rank,extents,elements,bytes,median,min,stddev,gb_per_s"
+        ",vs_reference\n";
+
+  for (auto const& r : results) {
+    index_type elements = 1;
+    for (auto x : r.extents) elements *= x;
+
+    os << std::defaultfloat << std::setprecision(9)
+       << suite << ',' << r.kernel << ',' << r.extents.size() << ','
+       << benchmark_extents_string(r) << ',' << elements << ',' << r.bytes
+       << ',' << r.time.median << ',' << r.time.min << ',' << r.time.stddev
+       << ',' << r.bytes / r.time.median * 1.0e-9 << ',';
+    if (auto const* ref = benchmark_find_reference(results, r, reference))
+      os << r.time.median / ref->time.median;
+    os << '\n';
+  }
+
+  os.flags(flags);
+  os.precision(precision);
+  os << std::flush;
+}
+
+// `check_abstraction_penalty(os, results, reference, options)` - Compares the
+// median time of each kernel to that of its reference kernel at the same
+// extents; the median is already robust to outlying samples. Returns false and
+// reports to `os` if any kernel selected by `options.penalty_kernels` and not
+// in `options.penalty_exempt_kernels` is slower than `options.max_penalty`
+// times the reference. Always succeeds if `options.max_penalty` is zero.
+inline bool check_abstraction_penalty(
+  std::ostream& os
+, std::vector<benchmark_result> const& results
+, std::string_view reference
+, benchmark_options const& options
+  )
+{
+  if (options.max_penalty <= 0.0)
+    return true;
+
+  auto const checked = [&] (std::string const& kernel) {
+    auto const listed = [&] (std::vector<std::string> const& kernels) {
+      return std::find(kernels.begin(), kernels.end(), kernel)
+          != kernels.end();
+    };
+    return (options.penalty_kernels.empty() || listed(options.penalty_kernels))
+        && !listed(options.penalty_exempt_kernels);
+  };
+
+  bool success = true;
+
+  for (auto const& r : results) {
+    auto const* ref = benchmark_find_reference(results, r, reference);
+    if (!ref || ref == &r || !checked(r.kernel))
+      continue;
+
+    auto const ratio = r.time.median / ref->time.median;
+
+    if (ratio > options.max_penalty) {
+      os << "error: " << r.kernel << " at extents [";
+      for (std::size_t e = 0; e != r.extents.size(); ++e)
+        os << (e ? ", " : "") << r.extents[e];
+      os << "] is " << ratio << "x slower than " << ref->kernel
+         << " (limit " << options.max_penalty << "x)\n";
+      success = false;
+    }
+  }
+
+  return success;
+}
+
+// `report_benchmarks(suite, reference, results, options)` - Prints `results`
+// to `std::cout` and, if `options.json` or `options.csv` name files, writes
+// them there too. `reference` is the reference kernel of every result that
+// doesn't name its own. Returns false if a file could not be written or if a
+// kernel exceeds the abstraction penalty limit (see
+// `check_abstraction_penalty`).
+inline bool report_benchmarks(
+  std::string_view suite
+, std::string_view reference
+, std::vector<benchmark_result> const& results
+, benchmark_options const& options
+  )
+{
+  benchmark_report(std::cout, results, reference);
+
+  if (options.counters
+   && std::none_of(results.begin(), results.end(),
+                   [] (auto const& r) { return r.counters_available; }))
+    std::cout << "note: hardware performance counters are unavailable\n";
+
+  if (!options.json.empty()) {
+    std::ofstream os(options.json);
+    benchmark_write_json(os, suite, results);
+    if (!os) {
+      std::cerr << "error: could not write '" << options.json << "'\n";
+      return false;
+    }
+  }
+
+  if (!options.csv.empty()) {
+    std::ofstream os(options.csv);
+    benchmark_write_csv(os, suite, results, reference);
+    if (!os) {
+      std::cerr << "error: could not write '" << options.csv << "'\n";
+      return false;
+    }
+  }
+
+  return check_abstraction_penalty(std::cerr, results, reference, options);
+}
+
+SPACES_END_NAMESPACE
+
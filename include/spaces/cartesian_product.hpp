@@ -9,9 +9,16 @@
 #pragma once
 
 #include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/fast_divisor.hpp>
 
+#include <array>
+#include <concepts>
+#include <functional>
 #include <ranges>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 SPACES_BEGIN_NAMESPACE
 
@@ -33,13 +40,49 @@ struct cartesian_product_view
   : std::ranges::view_interface<cartesian_product_view<Ranges...>>
 {
 private:
+  static constexpr bool sized_bases
+    = sizeof...(Ranges) != 0 && (std::ranges::sized_range<Ranges> && ...);
+
+  // The number of elements, the stride of each base in the flattened product
+  // and a divisor for each base's size. They're precomputed when every base
+  // is sized, which makes `size()`, advancing and distance O(1) per base and
+  // free of hardware division.
+  struct sized_bases_info
+  {
+    index_type size = 0;
+    std::array<index_type, sizeof...(Ranges)> strides{};
+    std::array<fast_divisor, sizeof...(Ranges)> divisors{};
+  };
+
+  struct unsized_bases_info {};
+
   std::tuple<Ranges...> bases;
+  [[no_unique_address]] std::conditional_t<
+    sized_bases, sized_bases_info, unsized_bases_info
+  > info;
+
+  template <std::size_t N = sizeof...(Ranges) - 1>
+  constexpr void compute_info(index_type stride = 1)
+  {
+    auto const extent = index_type(std::ranges::size(std::get<N>(bases)));
+    info.strides[N] = stride;
+    // Divisors are never used for empty bases, but can't be zero.
+    info.divisors[N] = fast_divisor(extent ? extent : 1);
+    if constexpr (N != 0) compute_info<N - 1>(stride * extent);
+    else                  info.size = stride * extent;
+  }
 
 public:
   constexpr cartesian_product_view() = default;
 
   constexpr cartesian_product_view(Ranges... base_)
-    : bases(std::move(base_)...) {}
+    : bases(std::move(base_)...)
+  {
+    if constexpr (sized_bases) compute_info();
+  }
+
+  template <std::size_t I>
+  constexpr auto const& base() const noexcept { return std::get<I>(bases); }
 
   template <bool IsConst>
   struct sentinel;
@@ -139,19 +182,19 @@ public:
     friend constexpr iterator operator+(iterator i, difference_type n)
       requires(std::ranges::random_access_range<Ranges> && ...)
     {
-      return {i + n};
+      return i += n;
     }
 
     friend constexpr iterator operator+(difference_type n, iterator i)
       requires(std::ranges::random_access_range<Ranges> && ...)
     {
-      return {i + n};
+      return i += n;
     }
 
     friend constexpr iterator operator-(iterator i, difference_type n)
       requires(std::ranges::random_access_range<Ranges> && ...)
     {
-      return {i - n};
+      return i -= n;
     }
 
     friend constexpr difference_type operator-(
@@ -165,7 +208,7 @@ public:
     constexpr decltype(auto) operator[](difference_type n) const
       requires(std::ranges::random_access_range<Ranges> && ...)
     {
-      return *iterator{*this + n};
+      return *(*this + n);
     }
 
     constexpr bool operator==(iterator const& other) const
@@ -249,10 +292,38 @@ public:
       --it;
     }
 
+    // The position of this iterator in the flattened product.
+    template <std::size_t N = sizeof...(Ranges) - 1>
+    constexpr index_type offset() const
+    {
+      auto const first = std::ranges::begin(std::get<N>(view->bases));
+      auto const o = index_type(std::get<N>(its) - first)
+                   * view->info.strides[N];
+      if constexpr (N != 0) return offset<N - 1>() + o;
+      else                  return o;
+    }
+
+    template <std::size_t N = sizeof...(Ranges) - 1>
+    constexpr void set_offset(index_type o)
+    {
+      auto const first = std::ranges::begin(std::get<N>(view->bases));
+      using D = std::iter_difference_t<decltype(first)>;
+      if constexpr (N != 0) {
+        auto const [q, r] = view->info.divisors[N].divide_remainder(o);
+        std::get<N>(its) = first + static_cast<D>(r);
+        set_offset<N - 1>(q);
+      } else {
+        std::get<N>(its) = first + static_cast<D>(o);
+      }
+    }
+
     template <std::size_t N = sizeof...(Ranges) - 1>
     constexpr difference_type distance(iterator const& other) const
     {
-      if constexpr (N == 0) {
+      if constexpr (sized_bases && N == sizeof...(Ranges) - 1) {
+        return difference_type(other.offset())
+             - difference_type(offset());
+      } else if constexpr (N == 0) {
         return std::get<0>(other.its) - std::get<0>(its);
       } else {
         const auto d = this->distance<N - 1>(other);
@@ -264,7 +335,17 @@ public:
     }
 
     template <std::size_t N = sizeof...(Ranges) - 1>
-    void advance(difference_type n)
+    constexpr void advance(difference_type n)
+    {
+      if constexpr (sized_bases) {
+        set_offset(index_type(difference_type(offset()) + n));
+      } else {
+        advance_unsized<N>(n);
+      }
+    }
+
+    template <std::size_t N = sizeof...(Ranges) - 1>
+    constexpr void advance_unsized(difference_type n)
     {
       if (n == 0)
         return;
@@ -286,7 +367,7 @@ public:
           mod += size;
           div--;
         }
-        advance<N - 1>(div);
+        advance_unsized<N - 1>(div);
       } else {
         if (div > 0) {
           mod = size;
@@ -335,13 +416,8 @@ public:
   constexpr auto size() const
     requires(std::ranges::sized_range<Ranges> && ...)
   {
-    return std::apply(
-      [] <typename... Args> (Args const&... args)
-      {
-        using Size = std::common_type_t<std::ranges::range_size_t<Args>...>;
-        return (Size(std::ranges::size(args)) * ...);
-      }
-    , bases);
+    using Size = std::common_type_t<std::ranges::range_size_t<Ranges>...>;
+    return Size(info.size);
   }
 
   constexpr auto begin()
@@ -411,5 +487,63 @@ struct cartesian_product_t
 
 inline constexpr cartesian_product_t cartesian_product{};
 
+template <typename R>
+inline constexpr bool is_bounded_iota_view = false;
+
+template <std::integral W>
+inline constexpr bool is_bounded_iota_view<std::ranges::iota_view<W, W>>
+  = true;
+
+// `iota_cartesian_product<V>` - True if `V` is a `cartesian_product_view` of
+// bounded integral `std::views::iota`s, which `for_each` lowers to a plain
+// loop nest.
+template <typename V>
+inline constexpr bool iota_cartesian_product = false;
+
+template <typename... Ranges>
+inline constexpr bool iota_cartesian_product<cartesian_product_view<Ranges...>>
+  = sizeof...(Ranges) != 0 && (is_bounded_iota_view<Ranges> && ...);
+
+// The innermost loop of `for_each` over an `iota_cartesian_product`. It's a
+// separate function because GCC ignores `ivdep` on loops inside `if constexpr`
+// in templates.
+template <typename W, typename F, typename... Is>
+constexpr void cartesian_product_iota_inner_loop(
+  W first, W last, F& f, Is... is
+  )
+{
+  SPACES_DEMAND_VECTORIZATION
+  for (W i = first; i != last; ++i) {
+    if constexpr (std::invocable<F&, Is..., W>)
+      std::invoke(f, is..., i);
+    else
+      std::invoke(f, std::tuple<Is..., W>(is..., i));
+  }
+}
+
+template <std::size_t K, typename View, typename F, typename... Is>
+constexpr void cartesian_product_iota_loops(View const& v, F& f, Is... is)
+{
+  auto const& base = v.template base<K>();
+  auto const first = *std::ranges::begin(base);
+  auto const last  = *std::ranges::end(base);
+  if constexpr (K + 1 == std::tuple_size_v<std::ranges::range_value_t<View>>)
+    cartesian_product_iota_inner_loop(first, last, f, is...);
+  else
+    for (auto i = first; i != last; ++i)
+      cartesian_product_iota_loops<K + 1>(v, f, is..., i);
+}
+
+// `for_each(v, f)` - Invokes `f` on each element of `v`, an
+// `iota_cartesian_product`, in order, with a counted loop per base instead of
+// the view's iterators. `f` is invoked with the indices, or with a tuple of
+// them if it can't be.
+template <typename Space, typename UnaryFunction>
+  requires iota_cartesian_product<std::remove_cvref_t<Space>>
+constexpr void for_each(Space&& space, UnaryFunction&& f)
+{
+  cartesian_product_iota_loops<0>(space, f);
+}
+
 SPACES_END_NAMESPACE
 
@@ -0,0 +1,324 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+#include <spaces/meta.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/mdspan.hpp>
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include <utility>
+
+SPACES_BEGIN_NAMESPACE
+
+// The rows and columns of the tiles that `copy` transposes: as many elements
+// as fit in a 256-bit vector register.
+template <typename T>
+inline constexpr index_type copy_tile_extent
+  = sizeof(T) >= 32 ? 1 : 32 / sizeof(T);
+
+// The extent below which `copy` stops subdividing a plane. A block of each
+// array fits in the L1 cache.
+inline constexpr index_type copy_block_extent = 32;
+
+// How `copy` walks a pair of arrays: as `planes` planes of axes `a`, along
+// which the source is most contiguous, and `b`, along which the destination
+// is most contiguous (or, if that's `a` too, the next best axis). The planes
+// are indexed by the remaining axes, the first of them varying fastest.
+template <index_type N>
+struct copy_plan
+{
+  index_type a = 0;
+  index_type b = 0;
+  index_type planes = 1;
+  std::array<index_type, N> extents{};
+  std::array<index_type, N> src_strides{};
+  std::array<index_type, N> dst_strides{};
+
+  // The offsets of the first element of plane `p` in the source and the
+  // destination.
+  constexpr std::pair<index_type, index_type>
+  plane_offsets(index_type p) const noexcept
+  {
+    index_type s = 0, d = 0;
+    for (index_type k = 0; k != N; ++k) {
+      if (k == a || k == b) continue;
+      index_type const i = p % extents[k];
+      p /= extents[k];
+      s += i * src_strides[k];
+      d += i * dst_strides[k];
+    }
+    return {s, d};
+  }
+};
+
+template <typename Src, typename Dst>
+constexpr copy_plan<Src::rank()> make_copy_plan(Src const& src, Dst const& dst)
+{
+  constexpr index_type N = Src::rank();
+
+  copy_plan<N> p;
+  for (index_type k = 0; k != N; ++k) {
+    p.extents[k] = src.extent(k);
+    p.src_strides[k] = src.stride(k);
+    p.dst_strides[k] = dst.stride(k);
+  }
+
+  auto argmin = [&] (auto cost, index_type skip) {
+    index_type best = skip == 0 ? 1 : 0;
+    for (index_type k = 0; k != N; ++k)
+      if (k != skip && cost(k) < cost(best)) best = k;
+    return best;
+  };
+
+  p.a = argmin([&] (index_type k) { return p.src_strides[k]; }, N);
+  p.b = argmin([&] (index_type k) { return p.dst_strides[k]; }, N);
+  if (p.a == p.b)
+    p.b = argmin(
+      [&] (index_type k) { return p.src_strides[k] + p.dst_strides[k]; }, p.a
+    );
+
+  for (index_type k = 0; k != N; ++k)
+    if (k != p.a && k != p.b) p.planes *= p.extents[k];
+
+  return p;
+}
+
+// True if `copy` can load and store `K` elements of `Src` and `Dst` at a time
+// as vectors of 4 8-byte elements, and shuffle them with
+// `__builtin_shufflevector`. Without AVX, the 256-bit vectors would be split
+// and passed in memory, so the shuffles are only used where AVX is enabled.
+template <index_type K, typename Src, typename Dst>
+inline constexpr bool copy_tile_shuffles =
+  #if defined(__AVX__) && defined(__has_builtin)
+    #if __has_builtin(__builtin_shufflevector)
+      K == 4
+   && std::is_arithmetic_v<typename Src::value_type>
+   && sizeof(typename Src::value_type) == 8
+   && std::is_same_v<typename Src::value_type, typename Dst::value_type>
+   && std::is_same_v<
+        typename Src::accessor_type
+      , std::experimental::default_accessor<typename Src::element_type>
+      >
+   && std::is_same_v<
+        typename Dst::accessor_type
+      , std::experimental::default_accessor<typename Dst::element_type>
+      >;
+    #else
+      false;
+    #endif
+  #else
+    false;
+  #endif
+
+// Copies a `K` x `K` tile whose columns are contiguous in the source and whose
+// rows are contiguous in the destination. Where `copy_tile_shuffles`, the
+// columns are loaded as vectors and transposed in registers; otherwise the
+// compiler is left to do what it can with a tile of known size.
+template <index_type K, typename Src, typename Dst>
+constexpr void copy_tile(
+  Src const& src, index_type src_off, index_type src_b
+, Dst const& dst, index_type dst_off, index_type dst_a
+  )
+{
+  if constexpr (copy_tile_shuffles<K, Src, Dst>) {
+    // Shuffles only move bits, so any 8-byte element can be moved as a
+    // `double`.
+    using V = double __attribute__((vector_size(32)));
+
+    // `__builtin_memcpy`, as `std::memcpy` isn't inlined with -fno-builtin.
+    auto load = [&] (index_type j) {
+      V v;
+      auto const* p = src.data_handle() + src_off + j * src_b;
+      __builtin_memcpy(&v, p, sizeof(V));
+      return v;
+    };
+    auto store = [&] (index_type i, V v) {
+      auto* p = dst.data_handle() + dst_off + i * dst_a;
+      __builtin_memcpy(p, &v, sizeof(V));
+    };
+
+    V const c0 = load(0), c1 = load(1), c2 = load(2), c3 = load(3);
+    V const t0 = __builtin_shufflevector(c0, c1, 0, 4, 2, 6);
+    V const t1 = __builtin_shufflevector(c0, c1, 1, 5, 3, 7);
+    V const t2 = __builtin_shufflevector(c2, c3, 0, 4, 2, 6);
+    V const t3 = __builtin_shufflevector(c2, c3, 1, 5, 3, 7);
+    store(0, __builtin_shufflevector(t0, t2, 0, 1, 4, 5));
+    store(1, __builtin_shufflevector(t1, t3, 0, 1, 4, 5));
+    store(2, __builtin_shufflevector(t0, t2, 2, 3, 6, 7));
+    store(3, __builtin_shufflevector(t1, t3, 2, 3, 6, 7));
+  } else {
+    typename Src::value_type tile[K][K];
+
+    for (index_type j = 0; j != K; ++j)
+      for (index_type i = 0; i != K; ++i)
+        tile[j][i] = src.accessor().access(
+          src.data_handle(), src_off + i + j * src_b
+        );
+
+    for (index_type i = 0; i != K; ++i)
+      for (index_type j = 0; j != K; ++j)
+        dst.accessor().access(dst.data_handle(), dst_off + j + i * dst_a)
+          = tile[j][i];
+  }
+}
+
+// Copies `n` contiguous elements.
+template <typename Src, typename Dst>
+constexpr void copy_contiguous_loop(
+  Src const& src, index_type src_off
+, Dst const& dst, index_type dst_off
+, index_type n
+  )
+{
+  SPACES_DEMAND_VECTORIZATION
+  for (index_type i = 0; i != n; ++i)
+    dst.accessor().access(dst.data_handle(), dst_off + i)
+      = src.accessor().access(src.data_handle(), src_off + i);
+}
+
+// Copies the elements `[i0, i1)` along axis `a` and `[j0, j1)` along axis `b`
+// of a plane that fits in the cache.
+template <index_type N, typename Src, typename Dst>
+constexpr void copy_block(
+  copy_plan<N> const& p
+, Src const& src, index_type src_off
+, Dst const& dst, index_type dst_off
+, index_type i0, index_type i1, index_type j0, index_type j1
+  )
+{
+  constexpr index_type K = copy_tile_extent<typename Src::value_type>;
+
+  index_type const src_a = p.src_strides[p.a], src_b = p.src_strides[p.b];
+  index_type const dst_a = p.dst_strides[p.a], dst_b = p.dst_strides[p.b];
+
+  auto copy_one = [&] (index_type i, index_type j) {
+    dst.accessor().access(dst.data_handle(), dst_off + i * dst_a + j * dst_b)
+      = src.accessor().access(
+          src.data_handle(), src_off + i * src_a + j * src_b
+        );
+  };
+
+  if (src_a == 1 && dst_a == 1) {
+    for (index_type j = j0; j != j1; ++j)
+      copy_contiguous_loop(
+        src, src_off + i0 + j * src_b, dst, dst_off + i0 + j * dst_b, i1 - i0
+      );
+  } else if (src_a == 1 && dst_b == 1) {
+    index_type j = j0;
+    for (; j + K <= j1; j += K) {
+      index_type i = i0;
+      for (; i + K <= i1; i += K)
+        copy_tile<K>(
+          src, src_off + i + j * src_b, src_b
+        , dst, dst_off + j + i * dst_a, dst_a
+        );
+      for (; i != i1; ++i)
+        for (index_type jj = j; jj != j + K; ++jj) copy_one(i, jj);
+    }
+    for (; j != j1; ++j)
+      for (index_type i = i0; i != i1; ++i) copy_one(i, j);
+  } else {
+    for (index_type j = j0; j != j1; ++j)
+      for (index_type i = i0; i != i1; ++i) copy_one(i, j);
+  }
+}
+
+// Copies the elements `[i0, i1)` along axis `a` and `[j0, j1)` along axis `b`
+// of a plane, halving the longer side until the pieces fit in the cache. The
+// halves are split at a multiple of the tile extent, so that tiles stay whole.
+template <index_type N, typename Src, typename Dst>
+constexpr void copy_blocks(
+  copy_plan<N> const& p
+, Src const& src, index_type src_off
+, Dst const& dst, index_type dst_off
+, index_type i0, index_type i1, index_type j0, index_type j1
+  )
+{
+  constexpr index_type K = copy_tile_extent<typename Src::value_type>;
+
+  index_type const ni = i1 - i0, nj = j1 - j0;
+  if (ni <= copy_block_extent && nj <= copy_block_extent) {
+    copy_block(p, src, src_off, dst, dst_off, i0, i1, j0, j1);
+  } else if (ni >= nj) {
+    index_type const mid = i0 + std::max(ni / 2 / K * K, K);
+    copy_blocks(p, src, src_off, dst, dst_off, i0, mid, j0, j1);
+    copy_blocks(p, src, src_off, dst, dst_off, mid, i1, j0, j1);
+  } else {
+    index_type const mid = j0 + std::max(nj / 2 / K * K, K);
+    copy_blocks(p, src, src_off, dst, dst_off, i0, i1, j0, mid);
+    copy_blocks(p, src, src_off, dst, dst_off, i0, i1, mid, j1);
+  }
+}
+
+// Copies the elements `[j0, j1)` along axis `b` of plane `plane`.
+template <index_type N, typename Src, typename Dst>
+constexpr void copy_plane(
+  copy_plan<N> const& p, Src const& src, Dst const& dst
+, index_type plane, index_type j0, index_type j1
+  )
+{
+  auto const [src_off, dst_off] = p.plane_offsets(plane);
+  // If both arrays are contiguous along the same axis, each row is read and
+  // written in cache lines anyway.
+  if (p.src_strides[p.a] == 1 && p.dst_strides[p.a] == 1)
+    copy_block(p, src, src_off, dst, dst_off, 0, p.extents[p.a], j0, j1);
+  else
+    copy_blocks(p, src, src_off, dst, dst_off, 0, p.extents[p.a], j0, j1);
+}
+
+// `copy(src, dst)` - Copies every element of `src` to the element of `dst`
+// with the same indices. `src` and `dst` must be strided `mdspan`s with the
+// same extents, but may have different layouts, e.g. `layout_left` and
+// `layout_right`, which makes `copy` a transpose; for ranks above 2, any
+// permutation of the axes.
+//
+// The arrays are copied plane by plane, along the axis that's most contiguous
+// in `src` and the one that's most contiguous in `dst`. Each plane is split
+// recursively until the pieces fit in the cache, so both arrays are accessed
+// in cache lines whatever the cache sizes are (i.e. the copy is
+// cache-oblivious). If the axes differ, the pieces are copied in small square
+// tiles that are transposed in registers.
+template <typename Src, typename Dst>
+  requires(specialization_of<Src, mdspan> && specialization_of<Dst, mdspan>)
+constexpr void copy(Src const& src, Dst const& dst)
+{
+  static_assert(
+    Src::rank() == Dst::rank()
+  , "The source and destination must have the same rank."
+  );
+  static_assert(
+    Src::mapping_type::is_always_strided()
+ && Dst::mapping_type::is_always_strided()
+  , "The source and destination must have strided layouts."
+  );
+
+  if constexpr (Src::rank() == 0) {
+    dst() = src();
+  } else if constexpr (Src::rank() == 1) {
+    index_type const ss = src.stride(0), ds = dst.stride(0);
+    if (ss == 1 && ds == 1) {
+      copy_contiguous_loop(src, 0, dst, 0, src.extent(0));
+    } else {
+      for (index_type i = 0; i != src.extent(0); ++i)
+        dst.accessor().access(dst.data_handle(), i * ds)
+          = src.accessor().access(src.data_handle(), i * ss);
+    }
+  } else {
+    if (src.size() == 0) return;
+    auto const p = make_copy_plan(src, dst);
+    for (index_type plane = 0; plane != p.planes; ++plane)
+      copy_plane(p, src, dst, plane, 0, p.extents[p.b]);
+  }
+}
+
+SPACES_END_NAMESPACE
+
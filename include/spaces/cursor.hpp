@@ -11,6 +11,9 @@
 #include <spaces/tuple.hpp>
 #include <spaces/mdrange.hpp>
 #include <spaces/space_bind.hpp>
+#include <spaces/extent_range.hpp>
+#include <spaces/storage_md_range.hpp>
+#include <spaces/mdspan.hpp>
 
 #include <type_traits>
 #include <concepts>
@@ -35,9 +38,25 @@ public:
     static_assert(sizeof...(Ts) == N);
   }
 
+  // The indices of an `mdspan` with extents `e`, whatever its layout. For a
+  // padded layout, these exclude the padding.
+  template <typename IndexType, std::size_t... Es>
+    requires(sizeof...(Es) == N)
+  explicit constexpr cursor(
+    std::experimental::extents<IndexType, Es...> const& e
+    )
+  {
+    for (index_type k = 0; k != N; ++k) data[k] = e.extent(k);
+  }
+
   constexpr cursor(cursor const& other) : data(other.data) {}
   constexpr cursor(cursor&& other) : data(std::move(other.data)) {}
 
+  constexpr std::array<index_type, N> const& extents() const noexcept
+  {
+    return data;
+  }
+
   template <typename OuterTuple>
   struct range;
 
@@ -46,7 +65,7 @@ public:
   {
     struct iterator
     {
-      using iterator_category = std::forward_iterator_tag;
+      using iterator_category = std::bidirectional_iterator_tag;
       using value_type = std::tuple<index_type, Outer...>;
       using difference_type = std::ptrdiff_t;
 
@@ -88,6 +107,19 @@ public:
         return tmp;
       }
 
+      constexpr iterator& operator--()
+      {
+        --std::get<0>(idx);
+        return *this;
+      }
+
+      constexpr iterator operator--(int)
+      {
+        iterator tmp(*this);
+        --(*this);
+        return tmp;
+      }
+
       constexpr iterator operator+(difference_type n) const
       {
         iterator tmp(*this);
@@ -98,10 +130,16 @@ public:
       constexpr auto operator*() { return idx; }
       constexpr auto operator*() const { return idx; }
 
-      constexpr bool
-      operator==(iterator const& it) const { return idx == it.idx; }
-      constexpr bool
-      operator!=(iterator const& it) const { return idx != it.idx; }
+      // Iterators of the same range share their outer indices, so only the
+      // first index needs to be compared.
+      constexpr bool operator==(iterator const& it) const
+      {
+        return std::get<0>(idx) == std::get<0>(it.idx);
+      }
+      constexpr bool operator!=(iterator const& it) const
+      {
+        return std::get<0>(idx) != std::get<0>(it.idx);
+      }
     };
 
   private:
@@ -137,13 +175,25 @@ public:
 
     constexpr iterator end() const { return last; }
 
-    constexpr auto size() const
+    constexpr index_type size() const { return std::get<0>(*last); }
+
+    // The same indices as an `extent_range`, whose bounds and step can be
+    // changed.
+    friend constexpr extent_range<Outer...> to_extent_range(range const& r)
     {
-      return tuple_reduce(*last, 1, std::multiplies{});
+      return std::apply(
+        [&] (index_type, Outer const&... outer)
+        {
+          return extent_range<Outer...>(
+            0, r.size(), 1, std::tuple<Outer...>(outer...)
+          );
+        }
+      , *r.first
+      );
     }
   };
 
-  static_assert(std::ranges::forward_range<range<std::tuple<>>>);
+  static_assert(std::ranges::bidirectional_range<range<std::tuple<>>>);
 
   template <index_type I, typename OuterTuple>
   friend constexpr auto mdrange(cursor space, OuterTuple&& outer) {
@@ -158,8 +208,23 @@ public:
   }
 };
 
+template <typename IndexType, std::size_t... Es>
+cursor(std::experimental::extents<IndexType, Es...> const&)
+  -> cursor<sizeof...(Es)>;
+
 template <index_type M>
 struct mdrank_t<cursor<M>> : std::integral_constant<index_type, M> {};
 
+// `flatten(space)` - The indices of `space` as a single sized random access
+// range of `std::array`s, in the order that `for_each` visits them (the first
+// index varying fastest). Unlike the space itself, it can be passed to the
+// standard parallel algorithms and to `std::ranges` algorithms that need
+// random access.
+template <index_type N>
+constexpr storage_md_range<N> flatten(cursor<N> const& space) noexcept
+{
+  return storage_md_range<N>(space.extents());
+}
+
 SPACES_END_NAMESPACE
 
@@ -0,0 +1,108 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+#include <spaces/on_extent.hpp>
+#include <spaces/extent_range.hpp>
+
+#include <type_traits>
+#include <utility>
+
+SPACES_BEGIN_NAMESPACE
+
+// `extent_bounds_factory<Adjust>` - A factory that changes the bounds or step
+// of the range of an extent by applying `adjust` to it as an `extent_range`.
+// Unlike range adaptors, it doesn't wrap the range's iterators, so the loop
+// over the extent stays a counted loop.
+template <typename Adjust>
+struct extent_bounds_factory
+{
+  Adjust adjust;
+
+  template <typename Range>
+  constexpr auto operator()(Range&& rng) const
+  {
+    static_assert(
+      extent_bounds_range<Range>
+    , "The bounds of an extent can only be changed before it's filtered or "
+      "transformed."
+    );
+    return adjust(to_extent_range(rng));
+  }
+};
+
+template <typename Adjust>
+extent_bounds_factory(Adjust) -> extent_bounds_factory<Adjust>;
+
+// `space | take<I>(n)` or `take<I>(space, n)` - `space` with only the first
+// `n` indices of extent `I`.
+template <index_type I>
+constexpr auto take(index_type n)
+{
+  return on_extent<I>(
+    extent_bounds_factory{[=] (auto e) { return e.take(n); }}
+  );
+}
+
+template <index_type I, typename Space>
+constexpr auto take(Space&& space, index_type n)
+{
+  return (Space&&)space | take<I>(n);
+}
+
+// `space | drop<I>(n)` or `drop<I>(space, n)` - `space` without the first `n`
+// indices of extent `I`.
+template <index_type I>
+constexpr auto drop(index_type n)
+{
+  return on_extent<I>(
+    extent_bounds_factory{[=] (auto e) { return e.drop(n); }}
+  );
+}
+
+template <index_type I, typename Space>
+constexpr auto drop(Space&& space, index_type n)
+{
+  return (Space&&)space | drop<I>(n);
+}
+
+// `space | stride<I>(s)` or `stride<I>(space, s)` - `space` with every `s`th
+// index of extent `I`, starting with the first. `s` must be positive.
+template <index_type I>
+constexpr auto stride(index_type s)
+{
+  return on_extent<I>(
+    extent_bounds_factory{[=] (auto e) { return e.stride(s); }}
+  );
+}
+
+template <index_type I, typename Space>
+constexpr auto stride(Space&& space, index_type s)
+{
+  return (Space&&)space | stride<I>(s);
+}
+
+// `space | reverse<I>()` or `reverse<I>(space)` - `space` with the indices of
+// extent `I` in the opposite order.
+template <index_type I>
+constexpr auto reverse()
+{
+  return on_extent<I>(
+    extent_bounds_factory{[] (auto e) { return e.reverse(); }}
+  );
+}
+
+template <index_type I, typename Space>
+constexpr auto reverse(Space&& space)
+{
+  return (Space&&)space | reverse<I>();
+}
+
+SPACES_END_NAMESPACE
+
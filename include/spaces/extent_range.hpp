@@ -0,0 +1,187 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <tuple>
+#include <utility>
+
+SPACES_BEGIN_NAMESPACE
+
+// `extent_range<Outer...>` - The indices `first`, `first + step`, ... of one
+// extent, `count` of them, each followed by the outer indices `Outer...`. It's
+// what the range of an extent of a `cursor` becomes when its bounds or step
+// are changed by `take`, `drop`, `stride` or `reverse`.
+//
+// Iterators count the elements they've visited and compute each index from
+// the count, so loops over an `extent_range` have a known trip count even
+// when `step` isn't known at compile time. A negative `step` is stored modulo
+// 2^N, as indices are unsigned.
+template <typename... Outer>
+struct extent_range
+{
+  struct iterator
+  {
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::tuple<index_type, Outer...>;
+    using difference_type = std::ptrdiff_t;
+
+  private:
+    index_type n = 0;
+    index_type first = 0;
+    index_type step = 1;
+    std::tuple<Outer...> outer;
+
+  public:
+    constexpr iterator() = default;
+
+    constexpr iterator(
+      index_type n_, index_type first_, index_type step_
+    , std::tuple<Outer...> const& outer_
+      )
+      : n(n_), first(first_), step(step_), outer(outer_)
+    {}
+
+    constexpr value_type operator*() const
+    {
+      return std::tuple_cat(std::make_tuple(first + n * step), outer);
+    }
+
+    constexpr value_type operator[](difference_type d) const
+    {
+      return *(*this + d);
+    }
+
+    constexpr iterator& operator++() { ++n; return *this; }
+    constexpr iterator& operator--() { --n; return *this; }
+
+    constexpr iterator operator++(int)
+    {
+      iterator tmp(*this);
+      ++n;
+      return tmp;
+    }
+    constexpr iterator operator--(int)
+    {
+      iterator tmp(*this);
+      --n;
+      return tmp;
+    }
+
+    constexpr iterator& operator+=(difference_type d)
+    {
+      n += d;
+      return *this;
+    }
+    constexpr iterator& operator-=(difference_type d)
+    {
+      n -= d;
+      return *this;
+    }
+
+    friend constexpr iterator operator+(iterator it, difference_type d)
+    {
+      return it += d;
+    }
+    friend constexpr iterator operator+(difference_type d, iterator it)
+    {
+      return it += d;
+    }
+    friend constexpr iterator operator-(iterator it, difference_type d)
+    {
+      return it -= d;
+    }
+
+    friend constexpr difference_type
+    operator-(iterator const& l, iterator const& r)
+    {
+      return difference_type(l.n - r.n);
+    }
+
+    // Iterators of the same range share everything but their count.
+    friend constexpr bool operator==(iterator const& l, iterator const& r)
+    {
+      return l.n == r.n;
+    }
+    friend constexpr auto operator<=>(iterator const& l, iterator const& r)
+    {
+      return l.n <=> r.n;
+    }
+  };
+
+private:
+  index_type first = 0;
+  index_type count = 0;
+  index_type step = 1;
+  std::tuple<Outer...> outer;
+
+public:
+  constexpr extent_range() = default;
+
+  constexpr extent_range(
+    index_type first_, index_type count_, index_type step_
+  , std::tuple<Outer...> outer_
+    )
+    : first(first_), count(count_), step(step_), outer(std::move(outer_))
+  {}
+
+  constexpr iterator begin() const { return iterator(0, first, step, outer); }
+
+  constexpr iterator end() const { return iterator(count, first, step, outer); }
+
+  constexpr index_type size() const { return count; }
+
+  // The first `n` indices.
+  constexpr extent_range take(index_type n) const
+  {
+    return extent_range(first, std::min(n, count), step, outer);
+  }
+
+  // All but the first `n` indices.
+  constexpr extent_range drop(index_type n) const
+  {
+    n = std::min(n, count);
+    return extent_range(first + n * step, count - n, step, outer);
+  }
+
+  // Every `s`th index, starting with the first. `s` must be positive.
+  constexpr extent_range stride(index_type s) const
+  {
+    return extent_range(first, (count + s - 1) / s, step * s, outer);
+  }
+
+  // The indices in the opposite order.
+  constexpr extent_range reverse() const
+  {
+    if (count == 0) return *this;
+    return extent_range(first + (count - 1) * step, count, -step, outer);
+  }
+
+  friend constexpr extent_range to_extent_range(extent_range const& r)
+  {
+    return r;
+  }
+};
+
+static_assert(std::ranges::random_access_range<extent_range<>>);
+static_assert(std::ranges::sized_range<extent_range<>>);
+
+// A range of the indices of one extent whose bounds and step can be changed,
+// like the ranges of the extents of a `cursor`.
+template <typename Range>
+concept extent_bounds_range = requires (Range const& rng) {
+  to_extent_range(rng);
+};
+
+SPACES_END_NAMESPACE
+
@@ -0,0 +1,82 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+
+#include <cstdint>
+#include <utility>
+
+SPACES_BEGIN_NAMESPACE
+
+// `fast_divisor` - Divides unsigned 64-bit integers by a divisor that is fixed
+// at construction, with a multiply and shifts instead of a hardware divide
+// (Granlund and Montgomery, "Division by Invariant Integers using
+// Multiplication", 1994, figure 4.1).
+//
+// Constructing one costs a 128-bit division, so it only pays off when the same
+// divisor is used many times. Platforms without 128-bit integers fall back to
+// hardware division.
+struct fast_divisor
+{
+private:
+  std::uint64_t divisor = 1;
+  std::uint64_t multiplier = 1;
+  std::uint8_t shift1 = 0;
+  std::uint8_t shift2 = 0;
+
+  #if defined(__SIZEOF_INT128__)
+    static constexpr std::uint64_t
+    multiply_high(std::uint64_t a, std::uint64_t b) noexcept
+    {
+      return std::uint64_t((unsigned __int128)a * b >> 64);
+    }
+  #endif
+
+public:
+  constexpr fast_divisor() noexcept = default;
+
+  // `d` must not be zero.
+  constexpr fast_divisor(index_type d) noexcept : divisor(d)
+  {
+    #if defined(__SIZEOF_INT128__)
+      // l = ceil(log2(d))
+      std::uint8_t l = 0;
+      while (l < 64 && (std::uint64_t(1) << l) < d) ++l;
+
+      // m = floor(2^64 * (2^l - d) / d) + 1
+      multiplier = std::uint64_t(
+        (((unsigned __int128)1 << l) - d) * ((unsigned __int128)1 << 64) / d
+      ) + 1;
+      shift1 = l < 1 ? l : 1;
+      shift2 = l < 1 ? 0 : l - 1;
+    #endif
+  }
+
+  constexpr index_type value() const noexcept { return divisor; }
+
+  constexpr index_type divide(index_type n) const noexcept
+  {
+    #if defined(__SIZEOF_INT128__)
+      std::uint64_t const t = multiply_high(multiplier, n);
+      return (t + ((n - t) >> shift1)) >> shift2;
+    #else
+      return n / divisor;
+    #endif
+  }
+
+  // Returns the quotient and remainder of `n / value()`.
+  constexpr std::pair<index_type, index_type>
+  divide_remainder(index_type n) const noexcept
+  {
+    index_type const q = divide(n);
+    return {q, n - q * divisor};
+  }
+};
+
+SPACES_END_NAMESPACE
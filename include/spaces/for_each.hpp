@@ -8,34 +8,58 @@
 #pragma once
 
 #include <spaces/config.hpp>
+#include <spaces/meta.hpp>
 #include <spaces/optimization_hints.hpp>
 #include <spaces/mdrange.hpp>
+#include <spaces/space_bind.hpp>
 #include <spaces/optional.hpp>
 #include <spaces/tuple.hpp>
 
 #include <type_traits>
 #include <utility>
 #include <functional>
+#include <optional>
 
 SPACES_BEGIN_NAMESPACE
 
+// Runs the loop over extent `I` and, for each of its elements, the loops over
+// the extents inside it. The fusible factories bound to extent `I` are applied
+// to each element in the loop body rather than as range adaptors, so a chain
+// of them costs one branch per element and constructs no `optional`s. The loop
+// bodies unwrap `optional`s themselves rather than with `invoke_o`, as the extra
+// layers of lambdas keep GCC from vectorizing longer chains.
 template <index_type I, typename Space, typename F, typename OuterTuple>
 constexpr void for_each_impl(Space&& space, F&& f, OuterTuple&& outer)
 {
+  auto [rng, stage] = fused_mdrange<I>(space, (OuterTuple&&)outer);
+
   if constexpr (I > 0) {
     SPACES_DEMAND_VECTORIZATION
-    for (auto&& e: mdrange<I>(space, (OuterTuple&&)outer)) {
-      invoke_o(
-        [&] <typename T> (T&& t) {
-          for_each_impl<I - 1>((Space&&)space, f, (T&&)t);
+    for (auto&& e: rng) {
+      stage(
+        std::forward<decltype(e)>(e)
+      , [&] <typename T> (T&& t) {
+          if constexpr (specialization_of<T, std::optional>) {
+            if (t.has_value()) for_each_impl<I - 1>(space, f, *((T&&)t));
+          } else {
+            for_each_impl<I - 1>(space, f, (T&&)t);
+          }
         }
-      , std::forward<decltype(e)>(e)
       );
     }
   } else {
     SPACES_DEMAND_VECTORIZATION
-    for (auto&& e: mdrange<I>((Space&&)space, (OuterTuple&&)outer)) {
-      apply_or_invoke_o((F&&)f, std::forward<decltype(e)>(e));
+    for (auto&& e: rng) {
+      stage(
+        std::forward<decltype(e)>(e)
+      , [&] <typename T> (T&& t) {
+          if constexpr (specialization_of<T, std::optional>) {
+            if (t.has_value()) apply_or_invoke(f, *((T&&)t));
+          } else {
+            apply_or_invoke(f, (T&&)t);
+          }
+        }
+      );
     }
   }
 }
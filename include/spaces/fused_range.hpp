@@ -0,0 +1,76 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+
+#include <functional>
+#include <utility>
+
+SPACES_BEGIN_NAMESPACE
+
+// A factory that can be applied to one element at a time by
+// `factory.stage(t, body)`, like the `_o` adaptors in `views.hpp`.
+template <typename Factory>
+concept fusible_factory = requires { requires Factory::fusible; };
+
+// `stage(t, body)` - Invokes `body` with `t`.
+// `stage.adapt(rng)` - Returns `rng`.
+struct identity_stage
+{
+  template <typename T, typename Body>
+  constexpr void operator()(T&& t, Body&& body) const
+  {
+    std::invoke((Body&&)body, (T&&)t);
+  }
+
+  template <typename Range>
+  constexpr auto adapt(Range&& rng) const
+  {
+    return (Range&&)rng;
+  }
+};
+
+// `stage(t, body)` - Applies `inner` and then `factory` to `t`, and invokes
+// `body` with the result, if any.
+// `stage.adapt(rng)` - Applies `inner` and then `factory` to `rng`.
+//
+// `Factory` may be a reference, in which case the factory must outlive the
+// stage.
+template <typename Inner, typename Factory>
+struct composed_stage
+{
+  Inner inner;
+  Factory factory;
+
+  template <typename T, typename Body>
+  constexpr void operator()(T&& t, Body&& body) const
+  {
+    inner((T&&)t, [&] <typename U> (U&& u) { factory.stage((U&&)u, body); });
+  }
+
+  template <typename Range>
+  constexpr auto adapt(Range&& rng) const
+  {
+    return factory(inner.adapt((Range&&)rng));
+  }
+};
+
+// A range and the stage to apply to each of its elements.
+template <typename Range, typename Stage>
+struct fused_range
+{
+  Range range;
+  Stage stage;
+};
+
+template <typename Range, typename Stage>
+fused_range(Range, Stage) -> fused_range<Range, Stage>;
+
+SPACES_END_NAMESPACE
+
@@ -0,0 +1,248 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+SPACES_BEGIN_NAMESPACE
+
+// The size of the huge pages that `huge_page_allocator` asks for, which is
+// the default on x86-64 and AArch64 Linux.
+inline constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+// How `huge_page_allocator` backs its allocations:
+//
+// * `none` - With base pages, like `std::aligned_alloc`.
+// * `transparent` - With transparent huge pages, if the kernel has them
+//   enabled for `madvise`d memory or always. Anything short of a whole huge
+//   page at the end is backed by base pages.
+// * `explicit_` - With huge pages reserved in `vm.nr_hugepages`, falling back
+//   to `transparent` if too few are free.
+enum class huge_pages { none, transparent, explicit_ };
+
+struct huge_page_options
+{
+  huge_pages pages = huge_pages::transparent;
+
+  // The alignment of allocations in bytes; a power of 2. Allocations are
+  // always aligned to at least a base page, and to a huge page if they're
+  // backed by huge pages.
+  std::size_t alignment = 0;
+
+  // The NUMA node to place allocations on, if it has free memory, or -1 to
+  // leave placement to the kernel (usually the node of the thread that first
+  // touches each page).
+  int numa_node = -1;
+
+  friend constexpr bool
+  operator==(huge_page_options const&, huge_page_options const&) = default;
+};
+
+namespace detail {
+
+[[noreturn]] inline void huge_page_allocation_failed()
+{
+  #if defined(__cpp_exceptions)
+    throw std::bad_alloc();
+  #else
+    std::abort();
+  #endif
+}
+
+#if defined(__linux__)
+
+inline std::size_t base_page_size() noexcept
+{
+  static std::size_t const size = std::size_t(::sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+inline void bind_to_numa_node(void* p, std::size_t bytes, int node) noexcept
+{
+  #if defined(SYS_mbind)
+    // The nodemask of `mbind(2)`, without depending on libnuma.
+    constexpr int bits = sizeof(unsigned long) * CHAR_BIT;
+    constexpr long mpol_preferred = 1;
+    std::array<unsigned long, 16> mask{};
+    if (node < 0 || node >= int(mask.size()) * bits) return;
+    mask[node / bits] = 1UL << (node % bits);
+    // The kernel ignores the last bit of `maxnode`.
+    ::syscall(
+      SYS_mbind, p, bytes, mpol_preferred, mask.data(), mask.size() * bits + 1
+    , 0
+    );
+  #endif
+}
+
+#endif
+
+} // namespace detail
+
+// `huge_page_allocator<T>` - An allocator that maps memory with `mmap`, backed
+// by huge pages and placed as its `huge_page_options` say, so that arrays of
+// many GBs don't miss in the TLB on every other page. Where `mmap` isn't
+// available, it falls back to `std::aligned_alloc`.
+//
+// Pages are faulted in, and placed, when they're first touched, which for a
+// `std::vector<T, huge_page_allocator<T>>(n)` is when it value-initializes
+// its elements.
+template <typename T>
+struct huge_page_allocator
+{
+  using value_type = T;
+  using is_always_equal = std::false_type;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  huge_page_options options;
+
+  constexpr huge_page_allocator() noexcept = default;
+
+  constexpr explicit huge_page_allocator(huge_page_options o) noexcept
+    : options(o)
+  {}
+
+  template <typename U>
+  constexpr huge_page_allocator(huge_page_allocator<U> const& other) noexcept
+    : options(other.options)
+  {}
+
+  // The alignment of, and the granularity of the sizes of, the mappings.
+  std::size_t granularity() const noexcept
+  {
+    std::size_t g = std::max(options.alignment, alignof(T));
+    #if defined(__linux__)
+      g = std::max(g, detail::base_page_size());
+      if (options.pages != huge_pages::none) g = std::max(g, huge_page_size);
+    #endif
+    return g;
+  }
+
+  // The size of the mapping of `n` elements: a multiple of the granularity,
+  // and never 0, as `mmap` can't map nothing.
+  std::size_t mapping_bytes(std::size_t n) const noexcept
+  {
+    std::size_t const g = granularity();
+    return std::max((n * sizeof(T) + g - 1) / g * g, g);
+  }
+
+  T* allocate(std::size_t n)
+  {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      detail::huge_page_allocation_failed();
+    std::size_t const g = granularity();
+    std::size_t const bytes = mapping_bytes(n);
+
+    #if defined(__linux__)
+      void* p = MAP_FAILED;
+      #if defined(MAP_HUGETLB)
+        if (options.pages == huge_pages::explicit_ && g == huge_page_size)
+          p = ::mmap(
+            nullptr, bytes, PROT_READ | PROT_WRITE
+          , MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0
+          );
+      #endif
+
+      if (p == MAP_FAILED) {
+        // Over-allocate by the alignment, and unmap what's either side of the
+        // aligned range.
+        std::size_t const extra = g - detail::base_page_size();
+        void* q = ::mmap(
+          nullptr, bytes + extra, PROT_READ | PROT_WRITE
+        , MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+        );
+        if (q == MAP_FAILED) detail::huge_page_allocation_failed();
+
+        auto const first = reinterpret_cast<std::uintptr_t>(q);
+        auto const aligned = (first + g - 1) / g * g;
+        if (aligned != first)
+          ::munmap(q, aligned - first);
+        if (std::size_t tail = extra - (aligned - first))
+          ::munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+        p = reinterpret_cast<void*>(aligned);
+
+        #if defined(MADV_HUGEPAGE)
+          if (options.pages != huge_pages::none)
+            ::madvise(p, bytes, MADV_HUGEPAGE);
+        #endif
+      }
+
+      if (options.numa_node >= 0)
+        detail::bind_to_numa_node(p, bytes, options.numa_node);
+
+      return static_cast<T*>(p);
+    #else
+      void* p = std::aligned_alloc(g, bytes);
+      if (!p) detail::huge_page_allocation_failed();
+      return static_cast<T*>(p);
+    #endif
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept
+  {
+    #if defined(__linux__)
+      ::munmap(p, mapping_bytes(n));
+    #else
+      std::free(p);
+    #endif
+  }
+
+  template <typename U>
+  friend constexpr bool operator==(
+    huge_page_allocator const& lhs, huge_page_allocator<U> const& rhs
+    ) noexcept
+  {
+    return lhs.options == rhs.options;
+  }
+};
+
+// `huge_page_mdarray<T, Extents, Layout>` - An `mdarray` whose elements are
+// allocated by a `huge_page_allocator`. Its `to_mdspan()` is the `mdspan` to
+// pass to kernels.
+template <
+  typename T
+, typename Extents
+, typename Layout = layout_right
+>
+using huge_page_mdarray = mdarray<
+  T, Extents, Layout, std::vector<T, huge_page_allocator<T>>
+>;
+
+// `make_huge_page_mdarray<T>(mapping, options)` - A `huge_page_mdarray` of
+// `T` with `mapping`, allocated as `options` say. Trivial elements are zero.
+template <typename T, typename Mapping>
+auto make_huge_page_mdarray(
+  Mapping const& mapping, huge_page_options options = {}
+  )
+{
+  using R = huge_page_mdarray<
+    T, typename Mapping::extents_type, typename Mapping::layout_type
+  >;
+  return R(mapping, huge_page_allocator<T>(options));
+}
+
+SPACES_END_NAMESPACE
+
@@ -13,37 +13,209 @@
 
 #include <spaces/optimization_hints.hpp>
 
+#include <algorithm>
 #include <array>
+#include <concepts>
 #include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
 
 SPACES_BEGIN_NAMESPACE
 
+// `index_generator_arena` - Caller-provided storage for `index_generator`
+// coroutine frames; pass it to `generate_indices` after `std::allocator_arg`.
+//
+// Frames are carved off the front of the buffer. Freeing the most recently
+// allocated frame returns its space, so an arena that is reused by one
+// generator at a time never runs out. When the buffer is full, frames come
+// from the heap instead.
+struct index_generator_arena
+{
+private:
+  std::byte* first;
+  std::byte* last;
+  std::byte* top;
+
+public:
+  constexpr index_generator_arena(void* buffer, std::size_t size) noexcept
+    : first(static_cast<std::byte*>(buffer))
+    , last(static_cast<std::byte*>(buffer) + size)
+    , top(static_cast<std::byte*>(buffer))
+  {}
+
+  index_generator_arena(index_generator_arena const&) = delete;
+  index_generator_arena& operator=(index_generator_arena const&) = delete;
+
+  // Returns null if the buffer is full.
+  void* allocate(std::size_t size) noexcept
+  {
+    size = (size + alignof(std::max_align_t) - 1)
+         / alignof(std::max_align_t) * alignof(std::max_align_t);
+    if (std::size_t(last - top) < size) return nullptr;
+    return std::exchange(top, top + size);
+  }
+
+  void deallocate(void* p, std::size_t size) noexcept
+  {
+    size = (size + alignof(std::max_align_t) - 1)
+         / alignof(std::max_align_t) * alignof(std::max_align_t);
+    if (static_cast<std::byte*>(p) + size == top)
+      top = static_cast<std::byte*>(p);
+  }
+
+  bool owns(void* p) const noexcept
+  {
+    return first <= static_cast<std::byte*>(p)
+        && static_cast<std::byte*>(p) < last;
+  }
+};
+
+// `index_generator_frame_pool` - Recycles `index_generator` coroutine frames
+// so that creating a generator in a loop doesn't call `::operator new` each
+// time. Freed frames go on a free list of their size class; frames larger
+// than the largest size class bypass the pool.
+//
+// Each thread uses its own pool (see `index_generator_frame_pool::local`), so
+// no synchronization is needed. A frame freed on a different thread than the
+// one that allocated it simply moves to the freeing thread's pool.
+struct index_generator_frame_pool
+{
+  static constexpr std::size_t granularity = 64;
+  static constexpr std::size_t size_classes = 64;
+
+private:
+  struct free_frame { free_frame* next; };
+
+  std::array<free_frame*, size_classes> free_lists{};
+
+  static constexpr std::size_t size_class(std::size_t size) noexcept
+  {
+    return (size + granularity - 1) / granularity - 1;
+  }
+
+public:
+  constexpr index_generator_frame_pool() noexcept = default;
+
+  index_generator_frame_pool(index_generator_frame_pool const&) = delete;
+  index_generator_frame_pool& operator=(index_generator_frame_pool const&)
+    = delete;
+
+  ~index_generator_frame_pool()
+  {
+    for (auto* f : free_lists)
+      while (f) ::operator delete(std::exchange(f, f->next));
+  }
+
+  static index_generator_frame_pool& local() noexcept
+  {
+    thread_local index_generator_frame_pool pool;
+    return pool;
+  }
+
+  void* allocate(std::size_t size)
+  {
+    auto const c = size_class(size);
+    if (c >= size_classes) return ::operator new(size);
+    if (auto* f = free_lists[c]) {
+      free_lists[c] = f->next;
+      return f;
+    }
+    return ::operator new((c + 1) * granularity);
+  }
+
+  void deallocate(void* p, std::size_t size) noexcept
+  {
+    auto const c = size_class(size);
+    if (c >= size_classes) return ::operator delete(p);
+    free_lists[c] = ::new (p) free_frame{free_lists[c]};
+  }
+};
+
+// `index_generator_promise_base` - Frame allocation shared by the promise
+// types of the index generators. Frames come from the thread's
+// `index_generator_frame_pool`, or from an `index_generator_arena` if the
+// coroutine's first parameters are `std::allocator_arg` and a non-null
+// pointer to one.
+struct index_generator_promise_base
+{
+private:
+  // Each frame is preceded by a header recording where it came from.
+  struct alignas(std::max_align_t) frame_header
+  {
+    index_generator_arena* arena;
+  };
+
+  static void* allocate(std::size_t size, index_generator_arena* arena)
+  {
+    size += sizeof(frame_header);
+    void* p = arena ? arena->allocate(size) : nullptr;
+    if (!p) {
+      arena = nullptr;
+      p = index_generator_frame_pool::local().allocate(size);
+    }
+    return ::new (p) frame_header{arena} + 1;
+  }
+
+public:
+  static void* operator new(std::size_t size)
+  {
+    return allocate(size, nullptr);
+  }
+
+  template <typename... Args>
+  static void* operator new(
+    std::size_t size
+  , std::allocator_arg_t
+  , index_generator_arena* arena
+  , Args const&...
+    )
+  {
+    return allocate(size, arena);
+  }
+
+  static void operator delete(void* p, std::size_t size) noexcept
+  {
+    auto* header = static_cast<frame_header*>(p) - 1;
+    size += sizeof(frame_header);
+    if (header->arena) header->arena->deallocate(header, size);
+    else index_generator_frame_pool::local().deallocate(header, size);
+  }
+
+  constexpr std::suspend_always initial_suspend() const noexcept
+  {
+    return {};
+  }
+
+  constexpr std::suspend_always final_suspend() const noexcept
+  {
+    return {};
+  }
+
+  constexpr void return_void() noexcept {}
+  constexpr void unhandled_exception() noexcept {}
+};
+
 template <index_type N>
 struct index_generator
 {
   static_assert(N != 0, "N must be greater than 0.");
 
-  struct promise_type
+  struct promise_type : index_generator_promise_base
   {
     using return_type = index_generator;
 
-    std::array<index_type, N> pos;
+    // The yielded index, which lives in the coroutine frame (or is a
+    // temporary of the `co_yield` expression) until the next resumption.
+    std::array<index_type, N> const* pos;
 
     constexpr std::suspend_always yield_value(
-      std::array<index_type, N> pos_
+      std::array<index_type, N> const& pos_
     ) noexcept
     {
-      pos = pos_;
-      return {};
-    }
-
-    constexpr std::suspend_always initial_suspend() const noexcept
-    {
-      return {};
-    }
-
-    constexpr std::suspend_always final_suspend() const noexcept
-    {
+      pos = &pos_;
       return {};
     }
 
@@ -51,9 +223,6 @@ struct index_generator
     {
       return index_generator(this);
     }
-
-    constexpr void return_void() noexcept {}
-    constexpr void unhandled_exception() noexcept {}
   };
 
   struct iterator
@@ -77,7 +246,7 @@ struct index_generator
 
     std::array<index_type, N> operator*() const
     {
-      return coro.promise().pos;
+      return *coro.promise().pos;
     }
 
     constexpr bool operator==(iterator const& rhs) const noexcept
@@ -167,6 +336,255 @@ inline index_generator<2> generate_indices(
   );
 }
 
+// `generate_indices(std::allocator_arg, arena, bounds)` - Yields every index
+// of the rank `N` space whose `d`th dimension spans
+// `[bounds[d][0], bounds[d][1])`, with the first index varying fastest, from a
+// coroutine whose frame is allocated from `arena` (or, if it is null, from the
+// thread's `index_generator_frame_pool`). Yields nothing if any dimension is
+// empty.
+template <index_type N>
+index_generator<N> generate_indices(
+  std::allocator_arg_t
+, index_generator_arena*
+, std::array<std::array<index_type, 2>, N> bounds
+  ) noexcept
+{
+  std::array<index_type, N> pos;
+  for (index_type d = 0; d != N; ++d) {
+    if (bounds[d][1] <= bounds[d][0]) co_return;
+    pos[d] = bounds[d][0];
+  }
+
+  while (true) {
+    for (pos[0] = bounds[0][0]; pos[0] != bounds[0][1]; ++pos[0])
+      co_yield pos;
+
+    // Advance the outer dimensions like an odometer.
+    index_type d = 1;
+    for (; d != N; ++d) {
+      if (++pos[d] != bounds[d][1]) break;
+      pos[d] = bounds[d][0];
+    }
+    if (d == N) co_return;
+  }
+}
+
+template <index_type N>
+index_generator<N> generate_indices(
+  std::allocator_arg_t
+, index_generator_arena& arena
+, std::array<std::array<index_type, 2>, N> bounds
+  ) noexcept
+{
+  return generate_indices<N>(std::allocator_arg, &arena, bounds);
+}
+
+template <index_type N>
+index_generator<N> generate_indices(
+  std::array<std::array<index_type, 2>, N> bounds
+  ) noexcept
+{
+  return generate_indices<N>(std::allocator_arg, nullptr, bounds);
+}
+
+// `batched_index_generator<N, B>` - Like `index_generator<N>`, but the
+// coroutine produces up to `B` indices each time it is resumed, and the
+// iterator walks that block before resuming it again. This amortizes the
+// resume/suspend pair over `B` elements instead of paying it for each one.
+template <index_type N, index_type B>
+struct batched_index_generator
+{
+  static_assert(N != 0, "N must be greater than 0.");
+  static_assert(B != 0, "B must be greater than 0.");
+
+  using block_type = std::span<std::array<index_type, N> const>;
+
+  struct promise_type : index_generator_promise_base
+  {
+    using return_type = batched_index_generator;
+
+    // The yielded block, which lives in the coroutine frame until the next
+    // resumption.
+    block_type block;
+
+    constexpr std::suspend_always yield_value(block_type block_) noexcept
+    {
+      block = block_;
+      return {};
+    }
+
+    batched_index_generator get_return_object() noexcept
+    {
+      return batched_index_generator(this);
+    }
+  };
+
+  struct iterator
+  {
+    std::coroutine_handle<promise_type> coro;
+    std::array<index_type, N> const* pos;
+    std::array<index_type, N> const* last;
+
+    constexpr iterator(std::coroutine_handle<promise_type> coro_) noexcept
+      : coro(coro_), pos(nullptr), last(nullptr)
+    {
+      if (coro && !coro.done()) {
+        pos  = coro.promise().block.data();
+        last = pos + coro.promise().block.size();
+      }
+    }
+
+    iterator& operator++()
+    {
+      if (++pos == last) {
+        coro.resume();
+        *this = iterator(coro);
+      }
+      return *this;
+    }
+
+    std::array<index_type, N> operator*() const
+    {
+      return *pos;
+    }
+
+    constexpr bool operator==(iterator const& rhs) const noexcept
+    {
+      return pos == rhs.pos;
+    }
+    constexpr bool operator!=(iterator const& rhs) const noexcept
+    {
+      return !(*this == rhs);
+    }
+  };
+
+  iterator begin()
+  {
+    p.resume();
+    return iterator(p);
+  }
+
+  constexpr iterator end()
+  {
+    return iterator(nullptr);
+  }
+
+  constexpr batched_index_generator(batched_index_generator&& rhs) noexcept
+    : p(rhs.p)
+  {
+    rhs.p = nullptr;
+  }
+
+  ~batched_index_generator()
+  {
+    if (p) p.destroy();
+  }
+
+private:
+  explicit batched_index_generator(promise_type* p) noexcept
+    : p(std::coroutine_handle<promise_type>::from_promise(*p))
+  {}
+
+  std::coroutine_handle<promise_type> p;
+};
+
+// Writes `n` copies of `pos` to `out`, with the first index of the `k`th copy
+// set to `first + k`. This is kept out of the coroutine body because compilers
+// keep the locals of a coroutine in its frame, so the loop would reload them
+// after every store.
+template <index_type N>
+inline void generate_indices_fill_row(
+  std::array<index_type, N>* __restrict__ out
+, std::array<index_type, N> pos
+, index_type first
+, index_type n
+  ) noexcept
+{
+  for (index_type k = 0; k != n; ++k) {
+    out[k] = pos;
+    out[k][0] = first + k;
+  }
+}
+
+// `generate_indices_batched<B>(std::allocator_arg, arena, bounds)` - Yields
+// the same indices as `generate_indices(std::allocator_arg, arena, bounds)`,
+// `B` at a time.
+template <index_type B, index_type N>
+batched_index_generator<N, B> generate_indices_batched(
+  std::allocator_arg_t
+, index_generator_arena*
+, std::array<std::array<index_type, 2>, N> bounds
+  ) noexcept
+{
+  std::array<std::array<index_type, N>, B> block;
+  index_type count = 0;
+
+  std::array<index_type, N> pos;
+  for (index_type d = 0; d != N; ++d) {
+    if (bounds[d][1] <= bounds[d][0]) co_return;
+    pos[d] = bounds[d][0];
+  }
+
+  while (true) {
+    // Copy as much of the current row into the block as fits.
+    for (index_type i = bounds[0][0]; i != bounds[0][1];) {
+      index_type const n = std::min(B - count, bounds[0][1] - i);
+      generate_indices_fill_row<N>(block.data() + count, pos, i, n);
+      i += n;
+      count += n;
+
+      if (count == B) {
+        co_yield std::span<std::array<index_type, N> const>(block.data(), count);
+        count = 0;
+      }
+    }
+
+    // Advance the outer dimensions like an odometer.
+    index_type d = 1;
+    for (; d != N; ++d) {
+      if (++pos[d] != bounds[d][1]) break;
+      pos[d] = bounds[d][0];
+    }
+    if (d == N) break;
+  }
+
+  if (count != 0)
+    co_yield std::span<std::array<index_type, N> const>(block.data(), count);
+}
+
+template <index_type B, index_type N>
+batched_index_generator<N, B> generate_indices_batched(
+  std::allocator_arg_t
+, index_generator_arena& arena
+, std::array<std::array<index_type, 2>, N> bounds
+  ) noexcept
+{
+  return generate_indices_batched<B, N>(std::allocator_arg, &arena, bounds);
+}
+
+template <index_type B, index_type N>
+batched_index_generator<N, B> generate_indices_batched(
+  std::array<std::array<index_type, 2>, N> bounds
+  ) noexcept
+{
+  return generate_indices_batched<B, N>(std::allocator_arg, nullptr, bounds);
+}
+
+// `generate_indices_batched<B>(n0, n1, ...)` - Yields every index of the
+// space with extents `n0, n1, ...`, `B` at a time.
+template <index_type B, std::convertible_to<index_type>... Extents>
+batched_index_generator<sizeof...(Extents), B> generate_indices_batched(
+  Extents... extents
+  ) noexcept
+{
+  return generate_indices_batched<B, sizeof...(Extents)>(
+    std::allocator_arg, nullptr
+  , std::array<std::array<index_type, 2>, sizeof...(Extents)>{
+      {{0, index_type(extents)}...}
+    }
+  );
+}
+
 SPACES_END_NAMESPACE
 
 #endif
@@ -11,168 +11,213 @@
 #include <spaces/optimization_hints.hpp>
 
 #include <array>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
 
 SPACES_BEGIN_NAMESPACE
 
-struct index_2d_range
+// `index_md_range<N>` - The indices of a rank `N` space, with the first index
+// varying fastest. Its iterator is random access: incrementing it is an
+// odometer step, while advancing, indexing and taking the distance between
+// two iterators convert to and from offsets in O(N), so the range can be split
+// into chunks for parallel algorithms.
+template <index_type N>
+struct index_md_range
 {
-  struct sentinel
-  {
-    index_type const extent1;
-
-    constexpr sentinel(index_type extent1_) noexcept : extent1(extent1_) {}
-  };
+  static_assert(N != 0, "N must be greater than 0.");
 
   struct iterator
   {
+    using iterator_concept  = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = std::array<index_type, N>;
+    using difference_type   = std::ptrdiff_t;
+
+    constexpr iterator() noexcept = default;
+
     constexpr iterator(
-      std::array<index_type, 2> indices_
-    , std::array<index_type, 2> extents_
+      std::array<index_type, N> indices_
+    , std::array<index_type, N> extents_
     ) noexcept
       : indices(indices_)
-      , extents{extents_}
+      , extents(extents_)
     {}
 
     constexpr iterator& operator++() noexcept
     {
-      SPACES_ASSUME(indices[0] >= 0);
-      SPACES_ASSUME(extents[0] >  0);
+      if (++indices[0] == extents[0] && N != 1) [[unlikely]]
+        carry();
+      return *this;
+    }
 
-      ++indices[0];                 // Inner loop iteration-expression.
+    constexpr iterator operator++(int) noexcept
+    {
+      iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
 
-      if (extents[0] == indices[0]) // Inner loop condition.
-      {
-        ++indices[1];               // Outer loop increment.
-        indices[0] = 0;             // Inner loop init-statement.
+    constexpr iterator& operator--() noexcept
+    {
+      for (index_type d = 0; d != N - 1; ++d) {
+        if (indices[d] != 0) {
+          --indices[d];
+          return *this;
+        }
+        indices[d] = extents[d] - 1;
       }
-
+      --indices[N - 1];
       return *this;
     }
 
-    // NOTE: ICPC requires this when we use an iterator-sentinel range.
-    friend constexpr index_type
-    operator-(iterator const& l, iterator const& r) noexcept
+    constexpr iterator operator--(int) noexcept
     {
-      SPACES_ASSUME(l.indices[0] >= 0);
-      SPACES_ASSUME(r.indices[0] >= 0);
-      SPACES_ASSUME(l.indices[1] >= 0);
-      SPACES_ASSUME(r.indices[1] >= 0);
-      SPACES_ASSUME(l.extents[0] >  0);
-      SPACES_ASSUME(l.extents[1] >  0);
+      iterator tmp(*this);
+      --*this;
+      return tmp;
+    }
 
-      return (l.indices[1] - r.indices[1])
-          * (l.extents[0]) - (l.indices[0] - r.indices[0]);
+    constexpr iterator& operator+=(difference_type d) noexcept
+    {
+      if (d != 0) {
+        index_type o = offset() + index_type(d);
+        for (index_type i = 0; i != N - 1; ++i) {
+          indices[i] = o % extents[i];
+          o /= extents[i];
+        }
+        indices[N - 1] = o;
+      }
+      return *this;
     }
 
-    // NOTE: ICPC requires this when we use an iterator-sentinel range.
-    friend constexpr index_type
-    operator-(iterator const& l, sentinel r) noexcept
+    constexpr iterator& operator-=(difference_type d) noexcept
     {
-      SPACES_ASSUME(l.indices[0] >= 0);
-      SPACES_ASSUME(l.indices[1] >= 0);
-      SPACES_ASSUME(l.extents[0] >  0);
-      SPACES_ASSUME(r.extent1    >  0);
+      return *this += -d;
+    }
 
-      return (l.indices[1] - r.extent1)
-           * (l.extents[0]) - (l.indices[0] - l.extents[0]);
+    friend constexpr iterator operator+(iterator it, difference_type d) noexcept
+    {
+      return it += d;
     }
-    friend constexpr index_type operator-(
-        sentinel r
-      , iterator const& l
-        ) noexcept
+    friend constexpr iterator operator+(difference_type d, iterator it) noexcept
     {
-      SPACES_ASSUME(l.indices[0] >= 0);
-      SPACES_ASSUME(l.indices[1] >= 0);
-      SPACES_ASSUME(l.extents[0] >  0);
-      SPACES_ASSUME(r.extent1    >  0);
-
-      return (r.extent1 - l.indices[1])
-           * (l.extents[0]) - (l.extents[0] - l.indices[0]);
+      return it += d;
     }
 
-    friend constexpr iterator operator+(iterator it, index_type d) noexcept
+    friend constexpr iterator operator-(iterator it, difference_type d) noexcept
     {
-      if (d == 0) return it;
-      return iterator(
-        {it.indices[0] + d % it.extents[0], it.indices[1] + d / it.extents[0]},
-        {it.extents[0], it.extents[1]}
-      );
+      return it -= d;
     }
 
-    // NOTE: ICPC requires this when we use an iterator-sentinel range.
-    constexpr iterator& operator+=(index_type d) noexcept
+    friend constexpr difference_type
+    operator-(iterator const& l, iterator const& r) noexcept
     {
-      if (d != 0) {
-        indices[0] += d % extents[0];
-        indices[1] += indices[1] + d / extents[0];
-      }
-      return *this;
+      return difference_type(l.offset()) - difference_type(r.offset());
     }
 
-    constexpr std::array<index_type, 2> operator[](index_type d) const noexcept
+    constexpr std::array<index_type, N> operator[](difference_type d)
+      const noexcept
     {
       return *(*this + d);
     }
 
-    constexpr std::array<index_type, 2> operator*() const noexcept
+    constexpr std::array<index_type, N> operator*() const noexcept
     {
       return indices;
     }
 
+    // Compares the last index first, as that is the one in which an iterator
+    // differs from the end of its range until the final row.
     friend constexpr bool
     operator==(iterator const& l, iterator const& r) noexcept
     {
-      SPACES_ASSUME(l.indices[0] >= 0);
-      SPACES_ASSUME(r.indices[0] >= 0);
-      SPACES_ASSUME(l.indices[1] >= 0);
-      SPACES_ASSUME(r.indices[1] >= 0);
-      SPACES_ASSUME(l.extents[0] >  0);
-      SPACES_ASSUME(r.extents[0] >  0);
-      SPACES_ASSUME(l.extents[1] >  0);
-      SPACES_ASSUME(r.extents[1] >  0);
-
-      return l.extents[0] == r.extents[0] && l.extents[1] == r.extents[1]
-          && l.indices[0] == r.indices[0] && l.indices[1] == r.indices[1];
+      for (index_type d = N; d != 0; --d)
+        if (l.indices[d - 1] != r.indices[d - 1]) return false;
+      return true;
     }
-    friend constexpr bool operator!=(iterator const& l, iterator const& r) noexcept
+
+    // Iterators into the same range order like their offsets, i.e. by their
+    // indices from the last dimension to the first.
+    friend constexpr std::strong_ordering
+    operator<=>(iterator const& l, iterator const& r) noexcept
     {
-      return !(l == r);
+      for (index_type d = N; d != 0; --d)
+        if (auto c = l.indices[d - 1] <=> r.indices[d - 1]; c != 0)
+          return c;
+      return std::strong_ordering::equal;
     }
 
-    friend constexpr bool operator==(iterator const& l, sentinel r) noexcept
+  private:
+    // Called when the first index reaches its extent; propagates the carry to
+    // the outer dimensions.
+    constexpr void carry() noexcept
     {
-      SPACES_ASSUME(l.indices[1] >= 0);
-      SPACES_ASSUME(r.extent1    >  0);
-
-      return l.indices[1] == r.extent1;
+      for (index_type d = 0; d != N - 1; ++d) {
+        if (indices[d] != extents[d]) break;
+        indices[d] = 0;
+        ++indices[d + 1];
+      }
     }
-    friend constexpr bool operator!=(iterator const& l, sentinel r) noexcept
+
+    // The distance from the first index of the space.
+    constexpr index_type offset() const noexcept
     {
-      return !(l == r);
+      index_type o = indices[N - 1];
+      for (index_type d = N - 1; d != 0; --d)
+        o = o * extents[d - 1] + indices[d - 1];
+      return o;
     }
 
-  private:
-    std::array<index_type, 2> indices;
-    std::array<index_type, 2> const extents;
+    std::array<index_type, N> indices{};
+    std::array<index_type, N> extents{};
   };
 
+  static_assert(std::random_access_iterator<iterator>);
+
 private:
-  iterator const first;
-  sentinel const last;
+  iterator first;
+  iterator last;
 
 public:
-  constexpr index_2d_range(index_type extent0, index_type extent1) noexcept
-    : first(
-        std::array<index_type, 2>{{0, 0}}
-      , std::array<index_type, 2>{{extent0, extent1}}
-      )
-    , last(extent1)
+  constexpr index_md_range(std::array<index_type, N> extents) noexcept
+  {
+    // The past-the-end iterator is where incrementing the last index carries
+    // out of the last dimension.
+    std::array<index_type, N> end{};
+    end[N - 1] = extents[N - 1];
+
+    bool empty = false;
+    for (auto e : extents) empty = empty || e == 0;
+
+    first = iterator(empty ? end : std::array<index_type, N>{}, extents);
+    last  = iterator(end, extents);
+  }
+
+  template <std::convertible_to<index_type>... Extents>
+    requires(sizeof...(Extents) == N)
+  constexpr index_md_range(Extents... extents) noexcept
+    : index_md_range(std::array<index_type, N>{index_type(extents)...})
   {}
 
   constexpr iterator begin() const noexcept { return first; }
 
-  constexpr sentinel end() const noexcept { return last; }
+  constexpr iterator end() const noexcept { return last; }
+
+  constexpr index_type size() const noexcept
+  {
+    return index_type(last - first);
+  }
 };
 
-SPACES_END_NAMESPACE
+template <std::convertible_to<index_type>... Extents>
+index_md_range(Extents...) -> index_md_range<sizeof...(Extents)>;
+
+template <index_type N>
+index_md_range(std::array<index_type, N>) -> index_md_range<N>;
 
+using index_2d_range = index_md_range<2>;
+
+SPACES_END_NAMESPACE
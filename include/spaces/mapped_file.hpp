@@ -0,0 +1,439 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#if __has_include(<sys/mman.h>)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #define SPACES_HAS_MAPPED_FILES
+#endif
+
+SPACES_BEGIN_NAMESPACE
+
+using std::experimental::default_accessor;
+
+// `mapped_accessor<T>` - The accessor policy of the `mdspan`s of a
+// `mapped_file`. It accesses elements like `default_accessor<T>`, and also
+// lets `for_each` tell the kernel how it's going to traverse them (see
+// `advisable_accessor`), so that the pages it's about to touch are read in
+// while it computes on the ones it has.
+template <typename T>
+struct mapped_accessor
+{
+  using offset_policy = mapped_accessor;
+  using element_type = T;
+  using reference = T&;
+  using data_handle_type = T*;
+
+  constexpr mapped_accessor() noexcept = default;
+
+  template <typename U>
+    requires(std::convertible_to<U(*)[], T(*)[]>)
+  constexpr mapped_accessor(mapped_accessor<U>) noexcept {}
+
+  template <typename U>
+    requires(std::convertible_to<T(*)[], U(*)[]>)
+  constexpr operator default_accessor<U>() const noexcept { return {}; }
+
+  constexpr data_handle_type offset(data_handle_type p, std::size_t i)
+    const noexcept
+  {
+    return p + i;
+  }
+
+  constexpr reference access(data_handle_type p, std::size_t i) const noexcept
+  {
+    return p[i];
+  }
+
+  // The `n` elements at `p` will be traversed in order.
+  void advise_sequential(data_handle_type p, std::size_t n) const noexcept
+  {
+    #if defined(SPACES_HAS_MAPPED_FILES)
+      advise(p, n, MADV_SEQUENTIAL);
+    #endif
+  }
+
+  // The `n` elements at `p` will be traversed soon, so read them in now,
+  // unless they already are; checking that is much cheaper than the page
+  // cache lookups of `MADV_WILLNEED`.
+  void advise_will_need(data_handle_type p, std::size_t n) const noexcept
+  {
+    #if defined(SPACES_HAS_MAPPED_FILES)
+      if (!resident(p, n)) advise(p, n, MADV_WILLNEED);
+    #endif
+  }
+
+private:
+  #if defined(SPACES_HAS_MAPPED_FILES)
+    // The whole pages that hold the `n` elements at `p`, which `madvise` and
+    // `mincore` take.
+    static std::pair<char*, std::size_t>
+    pages(data_handle_type p, std::size_t n) noexcept
+    {
+      static std::uintptr_t const page = ::sysconf(_SC_PAGESIZE);
+      auto const first = reinterpret_cast<std::uintptr_t>(p) / page * page;
+      auto const last = reinterpret_cast<std::uintptr_t>(p + n);
+      return {reinterpret_cast<char*>(first), last - first};
+    }
+
+    static void advise(data_handle_type p, std::size_t n, int advice) noexcept
+    {
+      auto const [first, bytes] = pages(p, n);
+      ::madvise(first, bytes, advice);
+    }
+
+    static bool resident(data_handle_type p, std::size_t n) noexcept
+    {
+      static std::size_t const page = ::sysconf(_SC_PAGESIZE);
+      auto [first, bytes] = pages(p, n);
+      unsigned char status[256];
+      while (bytes != 0) {
+        std::size_t const chunk = std::min(bytes, sizeof(status) * page);
+        if (::mincore(first, chunk, status) != 0) return false;
+        for (std::size_t i = 0; i != (chunk + page - 1) / page; ++i)
+          if (!(status[i] & 1)) return false;
+        first += chunk;
+        bytes -= chunk;
+      }
+      return true;
+    }
+  #endif
+};
+
+// The element types that a `mapped_file` records. Other trivially copyable
+// types are recorded as `opaque`, and only their sizes are checked.
+enum class mapped_element_type : std::uint32_t
+{
+  opaque, int8, uint8, int16, uint16, int32, uint32, int64, uint64
+, float32, float64
+};
+
+template <typename T>
+constexpr mapped_element_type mapped_element_type_of() noexcept
+{
+  using U = std::remove_cv_t<T>;
+  using enum mapped_element_type;
+  if constexpr (std::is_floating_point_v<U>) {
+    if constexpr (sizeof(U) == 4) return float32;
+    else if constexpr (sizeof(U) == 8) return float64;
+    else return opaque;
+  } else if constexpr (std::is_integral_v<U> && !std::is_same_v<U, bool>) {
+    constexpr bool s = std::is_signed_v<U>;
+    if constexpr (sizeof(U) == 1) return s ? int8 : uint8;
+    else if constexpr (sizeof(U) == 2) return s ? int16 : uint16;
+    else if constexpr (sizeof(U) == 4) return s ? int32 : uint32;
+    else if constexpr (sizeof(U) == 8) return s ? int64 : uint64;
+    else return opaque;
+  } else
+    return opaque;
+}
+
+// The layouts that a `mapped_file` records. Strided layouts other than
+// `layout_left` and `layout_right` (e.g. padded layouts or `submdspan`s) are
+// recorded as `stride`, by their strides, and are mapped as `layout_stride`.
+enum class mapped_layout : std::uint32_t { left, right, stride };
+
+template <typename Layout>
+constexpr mapped_layout mapped_layout_of() noexcept
+{
+  if constexpr (std::is_same_v<Layout, layout_left>)
+    return mapped_layout::left;
+  else if constexpr (std::is_same_v<Layout, layout_right>)
+    return mapped_layout::right;
+  else
+    return mapped_layout::stride;
+}
+
+inline constexpr std::size_t mapped_file_max_rank = 8;
+
+// The elements of a mapped file start at a multiple of this many bytes.
+inline constexpr std::size_t mapped_file_alignment = 64;
+
+// The header at the start of a mapped file. The elements follow it, at
+// `data_offset`, which is a multiple of `alignment`, in the byte order of the
+// machine that wrote them. The bytes in between are zero. `strides` are in
+// elements, and are recorded for every layout.
+struct mapped_file_header
+{
+  static constexpr char expected_magic[8] = {'S','P','A','C','E','S','M','D'};
+  static constexpr std::uint32_t current_version = 2;
+
+  char magic[8];
+  std::uint32_t version;
+  mapped_element_type element_type;
+  std::uint32_t element_size;
+  std::uint32_t rank;
+  mapped_layout layout;
+  std::uint32_t reserved;
+  std::uint64_t data_offset;
+  std::uint64_t alignment;
+  std::uint64_t extents[mapped_file_max_rank];
+  std::uint64_t strides[mapped_file_max_rank];
+};
+
+static_assert(std::is_trivially_copyable_v<mapped_file_header>);
+
+// `make_mapped_file_header<T>(mapping, alignment)` - The header of a file that
+// holds an array of `T` with `mapping`, a strided mapping, whose elements
+// start at a multiple of `alignment` bytes, a power of 2.
+template <typename T, typename Mapping>
+mapped_file_header make_mapped_file_header(
+  Mapping const& m, std::size_t alignment = mapped_file_alignment
+  ) noexcept
+{
+  using Extents = typename Mapping::extents_type;
+  static_assert(Extents::rank() <= mapped_file_max_rank);
+  static_assert(
+    Mapping::is_always_strided(), "A mapped file must have a strided layout."
+  );
+
+  mapped_file_header h{};
+  std::memcpy(h.magic, h.expected_magic, sizeof(h.magic));
+  h.version = h.current_version;
+  h.element_type = mapped_element_type_of<T>();
+  h.element_size = sizeof(T);
+  h.rank = Extents::rank();
+  h.layout = mapped_layout_of<typename Mapping::layout_type>();
+  h.alignment = std::max(alignment, alignof(T));
+  h.data_offset
+    = (sizeof(mapped_file_header) + h.alignment - 1)
+    / h.alignment * h.alignment;
+  if constexpr (Extents::rank() != 0)
+    for (std::size_t r = 0; r != Extents::rank(); ++r) {
+      h.extents[r] = m.extents().extent(r);
+      h.strides[r] = m.stride(r);
+    }
+  return h;
+}
+
+// `mapped_file_mapping<T, Extents, Layout>(h, bytes)` - The mapping of the
+// elements of a file of `bytes` bytes whose header is `h`. Empty if `h`
+// doesn't match `T`, the rank and static extents of `Extents` and `Layout`,
+// or if the file is too short. Any layout matches `layout_stride`, whose
+// strides are those in `h`; other layouts are built from the extents in `h`,
+// and only match if that gives the strides in `h` (e.g. a padded layout whose
+// padding differs doesn't).
+template <typename T, typename Extents, typename Layout>
+std::optional<typename Layout::template mapping<Extents>>
+mapped_file_mapping(mapped_file_header const& h, std::size_t bytes) noexcept
+{
+  if (std::memcmp(h.magic, h.expected_magic, sizeof(h.magic)) != 0
+   || h.version != h.current_version
+   || h.element_type != mapped_element_type_of<T>()
+   || h.element_size != sizeof(T)
+   || h.rank != Extents::rank()
+   || (!std::is_same_v<Layout, layout_stride>
+       && h.layout != mapped_layout_of<Layout>())
+   || h.data_offset % alignof(T) != 0
+   || h.data_offset > bytes)
+    return std::nullopt;
+
+  std::array<typename Extents::index_type, Extents::rank()> e{};
+  for (std::size_t r = 0; r != Extents::rank(); ++r) {
+    e[r] = h.extents[r];
+    if (Extents::static_extent(r) != std::experimental::dynamic_extent
+     && Extents::static_extent(r) != e[r])
+      return std::nullopt;
+  }
+
+  auto const m = [&] {
+    using M = typename Layout::template mapping<Extents>;
+    if constexpr (std::is_same_v<Layout, layout_stride>) {
+      std::array<typename Extents::index_type, Extents::rank()> s{};
+      for (std::size_t r = 0; r != Extents::rank(); ++r) s[r] = h.strides[r];
+      return M(Extents(e), s);
+    } else
+      return M(Extents(e));
+  }();
+  if constexpr (!std::is_same_v<Layout, layout_stride>)
+    for (std::size_t r = 0; r != Extents::rank(); ++r)
+      if (m.stride(r) != h.strides[r]) return std::nullopt;
+  if (m.required_span_size() > (bytes - h.data_offset) / sizeof(T))
+    return std::nullopt;
+  return m;
+}
+
+// `mapped_file<T, Extents, Layout>` - A file mapped into memory, whose
+// elements are viewed by `to_mdspan()`. If `T` is `const`, the file is mapped
+// read-only; otherwise, writes through the `mdspan` go to the file. The
+// mapping is released when the `mapped_file` is destroyed.
+//
+// Mapped files are opened by `open_mapped_file` and created by
+// `create_mapped_file`.
+template <typename T, typename Extents, typename Layout = layout_right>
+class mapped_file
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(Extents::rank() <= mapped_file_max_rank);
+
+public:
+  using element_type = T;
+  using extents_type = Extents;
+  using layout_type = Layout;
+  using mapping_type = typename Layout::template mapping<Extents>;
+  using mdspan_type = mdspan<T, Extents, Layout, mapped_accessor<T>>;
+
+private:
+  void* base = nullptr;
+  std::size_t bytes = 0;
+  mapping_type map{};
+
+  constexpr mapped_file(void* b, std::size_t n, mapping_type const& m) noexcept
+    : base(b), bytes(n), map(m)
+  {}
+
+  template <typename U, typename E, typename L>
+  friend std::optional<mapped_file<U, E, L>>
+  open_mapped_file(char const* path);
+
+  template <typename U, typename Mapping>
+  friend std::optional<mapped_file<
+    U, typename Mapping::extents_type, typename Mapping::layout_type
+  >>
+  create_mapped_file(char const* path, Mapping const& m);
+
+public:
+  mapped_file(mapped_file const&) = delete;
+  mapped_file& operator=(mapped_file const&) = delete;
+
+  mapped_file(mapped_file&& other) noexcept
+    : base(std::exchange(other.base, nullptr))
+    , bytes(std::exchange(other.bytes, 0))
+    , map(other.map)
+  {}
+
+  mapped_file& operator=(mapped_file&& other) noexcept
+  {
+    std::swap(base, other.base);
+    std::swap(bytes, other.bytes);
+    std::swap(map, other.map);
+    return *this;
+  }
+
+  ~mapped_file()
+  {
+    #if defined(SPACES_HAS_MAPPED_FILES)
+      if (base) ::munmap(base, bytes);
+    #endif
+  }
+
+  mapping_type const& mapping() const noexcept { return map; }
+
+  T* data() const noexcept
+  {
+    auto const& h = *static_cast<mapped_file_header const*>(base);
+    return reinterpret_cast<T*>(static_cast<char*>(base) + h.data_offset);
+  }
+
+  mdspan_type to_mdspan() const noexcept { return mdspan_type(data(), map); }
+
+  // Writes the elements back to the file now, rather than when the kernel
+  // gets to it.
+  void sync() const noexcept requires(!std::is_const_v<T>)
+  {
+    #if defined(SPACES_HAS_MAPPED_FILES)
+      ::msync(base, bytes, MS_SYNC);
+    #endif
+  }
+};
+
+// `open_mapped_file<T, Extents, Layout>(path)` - Maps the file at `path`, read
+// only if `T` is `const`. Empty if the file can't be mapped, or if its header
+// doesn't match `T`, the rank and static extents of `Extents` and `Layout`.
+template <typename T, typename Extents, typename Layout = layout_right>
+std::optional<mapped_file<T, Extents, Layout>>
+open_mapped_file(char const* path)
+{
+  #if defined(SPACES_HAS_MAPPED_FILES)
+    using R = mapped_file<T, Extents, Layout>;
+    constexpr bool writable = !std::is_const_v<T>;
+
+    int const fd = ::open(path, writable ? O_RDWR : O_RDONLY);
+    if (fd < 0) return std::nullopt;
+    struct ::stat st;
+    void* base = MAP_FAILED;
+    std::size_t const bytes = ::fstat(fd, &st) == 0 ? st.st_size : 0;
+    if (bytes >= sizeof(mapped_file_header))
+      base = ::mmap(
+        nullptr, bytes, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED
+      , fd, 0
+      );
+    ::close(fd);
+    if (base == MAP_FAILED) return std::nullopt;
+
+    // Unmaps the file if it turns out to be invalid.
+    R file(base, bytes, {});
+
+    auto const m = mapped_file_mapping<T, Extents, Layout>(
+      *static_cast<mapped_file_header const*>(base), bytes
+    );
+    if (!m) return std::nullopt;
+    file.map = *m;
+
+    return std::optional<R>(std::move(file));
+  #else
+    return std::nullopt;
+  #endif
+}
+
+// `create_mapped_file<T>(path, mapping)` - Creates a file at `path`, or
+// truncates the file there, that holds an array of `T` with `mapping`, and
+// maps it read-write. The elements are zero. Empty if the file can't be
+// created.
+template <typename T, typename Mapping>
+std::optional<mapped_file<
+  T, typename Mapping::extents_type, typename Mapping::layout_type
+>>
+create_mapped_file(char const* path, Mapping const& m)
+{
+  #if defined(SPACES_HAS_MAPPED_FILES)
+    using Extents = typename Mapping::extents_type;
+    using Layout = typename Mapping::layout_type;
+    using R = mapped_file<T, Extents, Layout>;
+    static_assert(!std::is_const_v<T>);
+
+    auto const h = make_mapped_file_header<T>(m);
+    std::size_t const bytes
+      = h.data_offset + m.required_span_size() * sizeof(T);
+
+    int const fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return std::nullopt;
+    void* base = MAP_FAILED;
+    if (::ftruncate(fd, bytes) == 0)
+      base = ::mmap(
+        nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0
+      );
+    ::close(fd);
+    if (base == MAP_FAILED) return std::nullopt;
+
+    std::memcpy(base, &h, sizeof(h));
+
+    return std::optional<R>(R(base, bytes, m));
+  #else
+    return std::nullopt;
+  #endif
+}
+
+SPACES_END_NAMESPACE
+
@@ -5704,6 +5704,7 @@ using std::experimental::layout_left;
 using std::experimental::layout_right;
 using std::experimental::layout_stride;
 using std::experimental::extents;
+using std::experimental::mdarray;
 
 template <size_t Rank>
 using dextents = typename std::experimental::detail::__make_dextents<size_t, Rank>::type;
@@ -11,6 +11,9 @@
 #include <spaces/meta.hpp>
 #include <spaces/space_bind.hpp>
 
+#include <concepts>
+#include <type_traits>
+
 SPACES_BEGIN_NAMESPACE
 
 template <typename Index, typename Factory>
@@ -29,11 +32,11 @@ public:
   constexpr on_extent_factory(on_extent_factory&&) = default;
 
   template <typename Space, typename UFactory>
-    requires(specialization_of<UFactory, on_extent_factory>)
+    requires(std::same_as<std::remove_cvref_t<UFactory>, on_extent_factory>)
   friend constexpr auto space_bind(Space&& space, UFactory&& factory)
   {
     using T = space_binder<
-      std::remove_cvref_t<Space>, UFactory::index, decltype(factory.underlying)
+      std::remove_cvref_t<Space>, index, decltype(factory.underlying)
     >;
     return T((Space&&)space, ((UFactory&&)factory).underlying);
   }
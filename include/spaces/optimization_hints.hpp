@@ -54,6 +54,22 @@
     #define SPACES_PREVENT_VECTORIZATION
 #endif
 
+// SPACES_DO_NOT_OPTIMIZE(expr) - Tell the compiler that the value of expr is
+// used, so that it must be computed, without generating any code to use it.
+// Useful for keeping the body of a loop that is being timed from being
+// optimized away or folded into a closed form:
+//
+// for (auto i = 0; i != N; ++i) SPACES_DO_NOT_OPTIMIZE(i);
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+  #define SPACES_DO_NOT_OPTIMIZE(expr)                                        \
+    __asm__ volatile("" : : "r"(expr))                                        \
+    /**/
+#else
+  #define SPACES_DO_NOT_OPTIMIZE(expr)                                        \
+    ((void)(expr))                                                            \
+    /**/
+#endif
+
 // Sometimes it is nice to check that our brash and bold claims are, in fact,
 // correct. Defining SPACES_CHECK_ASSUMPTIONS does that (e.g. assumption will be
 // asserted before they are assumed).
@@ -0,0 +1,193 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+SPACES_BEGIN_NAMESPACE
+
+using std::experimental::dynamic_extent;
+
+template <typename Layout, typename Extents>
+class padded_mapping;
+
+// `layout_left_padded<P>` - Like `layout_left`, except that the first extent
+// is padded to a multiple of `P` elements, so the stride of the second extent
+// may exceed the first extent (see P2642). If `P` is `dynamic_extent`, the
+// padding is given to the mapping's constructor.
+template <std::size_t PaddingValue = dynamic_extent>
+struct layout_left_padded
+{
+  static constexpr std::size_t padding_value = PaddingValue;
+  static constexpr bool left = true;
+
+  template <typename Extents>
+  using mapping = padded_mapping<layout_left_padded, Extents>;
+};
+
+// `layout_right_padded<P>` - Like `layout_right`, except that the last extent
+// is padded to a multiple of `P` elements (see `layout_left_padded`).
+template <std::size_t PaddingValue = dynamic_extent>
+struct layout_right_padded
+{
+  static constexpr std::size_t padding_value = PaddingValue;
+  static constexpr bool left = false;
+
+  template <typename Extents>
+  using mapping = padded_mapping<layout_right_padded, Extents>;
+};
+
+// The mapping of `layout_left_padded` and `layout_right_padded`. Only the
+// stride of the extent next to the padded one is rounded up; the other
+// strides are the products of the padded extent and the extents in between.
+// Arrays of rank 0 or 1 aren't padded.
+template <typename Layout, typename Extents>
+class padded_mapping
+{
+public:
+  using extents_type = Extents;
+  using index_type = typename extents_type::index_type;
+  using size_type = typename extents_type::size_type;
+  using rank_type = typename extents_type::rank_type;
+  using layout_type = Layout;
+
+private:
+  static constexpr rank_type R = extents_type::rank();
+
+  // The extent that's padded, and the loop order from fastest to slowest.
+  static constexpr rank_type padded_rank = Layout::left || R == 0 ? 0 : R - 1;
+
+  static constexpr rank_type dim(rank_type k) noexcept
+  {
+    return Layout::left ? k : R - 1 - k;
+  }
+
+  extents_type exts{};
+  index_type padded_extent = 0;
+
+public:
+  constexpr padded_mapping() noexcept : padded_mapping(extents_type{}) {}
+
+  // The padding is `Layout::padding_value`, or none if that's dynamic.
+  constexpr padded_mapping(extents_type const& e) noexcept
+    : padded_mapping(
+        e
+      , Layout::padding_value == dynamic_extent
+          ? index_type(1) : index_type(Layout::padding_value)
+      )
+  {}
+
+  // The padded extent is the least multiple of `padding` that's no less than
+  // the extent. `padding` must be positive.
+  constexpr padded_mapping(extents_type const& e, index_type padding) noexcept
+    : exts(e)
+  {
+    if constexpr (R != 0) {
+      index_type const n = exts.extent(padded_rank);
+      padded_extent = (n + padding - 1) / padding * padding;
+    }
+  }
+
+  constexpr extents_type const& extents() const noexcept { return exts; }
+
+  constexpr index_type required_span_size() const noexcept
+  {
+    if constexpr (R == 0)
+      return 1;
+    else {
+      for (rank_type r = 0; r != R; ++r)
+        if (exts.extent(r) == 0) return 0;
+      if constexpr (R == 1)
+        return exts.extent(0);
+      else
+        return stride(dim(R - 1)) * exts.extent(dim(R - 1));
+    }
+  }
+
+  template <typename... Indices>
+    requires(sizeof...(Indices) == R
+          && (std::is_convertible_v<Indices, index_type> && ...))
+  constexpr index_type operator()(Indices... is) const noexcept
+  {
+    if constexpr (R == 0)
+      return 0;
+    else {
+      std::array<index_type, R> const idx{index_type(is)...};
+      // Horner's rule, from the slowest extent inwards.
+      index_type offset = idx[dim(R - 1)];
+      for (rank_type k = R - 1; k > 1; --k)
+        offset = offset * exts.extent(dim(k - 1)) + idx[dim(k - 1)];
+      if constexpr (R > 1)
+        offset = offset * padded_extent + idx[dim(0)];
+      return offset;
+    }
+  }
+
+  static constexpr bool is_always_unique() noexcept { return true; }
+  static constexpr bool is_always_exhaustive() noexcept { return R < 2; }
+  static constexpr bool is_always_strided() noexcept { return true; }
+
+  static constexpr bool is_unique() noexcept { return true; }
+  constexpr bool is_exhaustive() const noexcept
+  {
+    if constexpr (R < 2)
+      return true;
+    else
+      return padded_extent == exts.extent(padded_rank);
+  }
+  static constexpr bool is_strided() noexcept { return true; }
+
+  constexpr index_type stride(rank_type r) const noexcept
+    requires(R > 0)
+  {
+    if (r == dim(0)) return 1;
+    index_type s = padded_extent;
+    for (rank_type k = 1; dim(k) != r; ++k)
+      s *= exts.extent(dim(k));
+    return s;
+  }
+
+  template <typename OtherExtents>
+  friend constexpr bool operator==(
+    padded_mapping const& lhs, padded_mapping<Layout, OtherExtents> const& rhs
+    ) noexcept
+  {
+    if (lhs.extents() != rhs.extents()) return false;
+    if constexpr (R > 1)
+      return lhs.stride(dim(1)) == rhs.stride(dim(1));
+    else
+      return true;
+  }
+};
+
+// `aliasing_free_padding<T>(n)` - A padding for a padded layout whose padded
+// extent, `n` elements of `T`, makes the stride of the next extent an odd
+// number of `line`-byte cache lines. Power of 2 strides map every row (or
+// column) to the same few cache sets; odd strides spread them over all of
+// them. The stride is also a whole number of cache lines, so each row (or
+// column) starts as aligned as the first.
+template <typename T>
+constexpr index_type aliasing_free_padding(
+  index_type n, index_type line = 64
+  ) noexcept
+{
+  if (sizeof(T) > line || line % sizeof(T) != 0) return n | 1;
+  index_type const per_line = line / sizeof(T);
+  index_type lines = (n + per_line - 1) / per_line;
+  if (lines % 2 == 0) ++lines;
+  // A padding no less than `n` pads `n` to itself.
+  return lines * per_line;
+}
+
+SPACES_END_NAMESPACE
+
@@ -0,0 +1,61 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+#include <spaces/meta.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/copy.hpp>
+#include <spaces/parallel_for_each.hpp>
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+SPACES_BEGIN_NAMESPACE
+
+// `copy(policy, src, dst)` - Like `copy(src, dst)`, but with the parallel
+// algorithms of the standard library. Each plane is split into bands along
+// axis `b` of whole blocks; the bands of all planes are the tasks.
+template <typename ExecutionPolicy, typename Src, typename Dst>
+  requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+        && specialization_of<Src, mdspan> && specialization_of<Dst, mdspan>
+void copy(ExecutionPolicy&& policy, Src const& src, Dst const& dst)
+{
+  if constexpr (Src::rank() < 2) {
+    copy(src, dst);
+  } else {
+    if (src.size() == 0) return;
+    auto const p = make_copy_plan(src, dst);
+
+    index_type const nb = p.extents[p.b];
+    index_type const blocks = (nb + copy_block_extent - 1) / copy_block_extent;
+    index_type const bands = std::clamp(
+      parallel_for_each_chunks(p.planes * blocks) / p.planes
+    , index_type(1), blocks
+    );
+    index_type const band = (blocks + bands - 1) / bands * copy_block_extent;
+
+    std::vector<index_type> ids(p.planes * bands);
+    std::iota(ids.begin(), ids.end(), index_type(0));
+
+    std::for_each((ExecutionPolicy&&)policy, ids.begin(), ids.end()
+    , [&] (index_type t)
+      {
+        index_type const j0 = t % bands * band;
+        if (j0 < nb)
+          copy_plane(p, src, dst, t / bands, j0, std::min(j0 + band, nb));
+      }
+    );
+  }
+}
+
+SPACES_END_NAMESPACE
+
@@ -0,0 +1,137 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+#include <spaces/meta.hpp>
+#include <spaces/cartesian_product.hpp>
+
+#include <algorithm>
+#include <execution>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <ranges>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+SPACES_BEGIN_NAMESPACE
+
+// The number of chunks that a parallel `for_each` splits `n` elements into.
+// A few per hardware thread, so that uneven chunks can be balanced.
+inline index_type parallel_for_each_chunks(index_type n) noexcept
+{
+  index_type const threads = std::max(std::thread::hardware_concurrency(), 1U);
+  return std::min(n, 4 * threads);
+}
+
+// Invokes `f` with the elements of `t`, or with `t` itself if it can't be.
+template <typename F, typename Tuple>
+constexpr void cartesian_product_invoke(F& f, Tuple&& t)
+{
+  using T = std::remove_cvref_t<Tuple>;
+  constexpr bool applicable = [] <std::size_t... I> (std::index_sequence<I...>)
+  {
+    return std::invocable<F&, std::tuple_element_t<I, T>...>;
+  }(std::make_index_sequence<std::tuple_size_v<T>>{});
+
+  if constexpr (applicable)
+    std::apply(f, (Tuple&&)t);
+  else
+    std::invoke(f, (Tuple&&)t);
+}
+
+// `for_each(policy, v, f)` - Invokes `f` on each element of `v`, a
+// `cartesian_product_view`, with the parallel algorithms of the standard
+// library, as if by `std::for_each(policy, ...)`. `f` is invoked with the
+// elements of each tuple, or with the tuple if it can't be.
+//
+// If every base is a sized random access range, the product is split into
+// chunks of consecutive elements; each chunk advances an iterator to its
+// first element once and then increments it. Otherwise, every base must be a
+// forward range, and the first base is split: each of its elements is a task
+// that iterates over the product of the remaining bases.
+template <typename ExecutionPolicy, typename Space, typename UnaryFunction>
+  requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+        && specialization_of<std::remove_cvref_t<Space>, cartesian_product_view>
+void for_each(ExecutionPolicy&& policy, Space&& space, UnaryFunction&& f)
+{
+  auto& v = space;
+
+  if constexpr (std::ranges::random_access_range<decltype(v)>
+             && std::ranges::sized_range<decltype(v)>) {
+    using D = std::ranges::range_difference_t<decltype(v)>;
+
+    index_type const n = std::ranges::size(v);
+    if (n == 0) return;
+    index_type const chunks = parallel_for_each_chunks(n);
+
+    // The first element of chunk `c`.
+    auto start = [=] (index_type c)
+    { return n / chunks * c + std::min(c, n % chunks); };
+
+    std::vector<index_type> ids(chunks);
+    std::iota(ids.begin(), ids.end(), index_type(0));
+
+    std::for_each((ExecutionPolicy&&)policy, ids.begin(), ids.end()
+    , [&] (index_type c)
+      {
+        index_type const first = start(c);
+        index_type const last  = start(c + 1);
+        auto it = std::ranges::begin(v) + D(first);
+        for (index_type i = first; i != last; ++i, ++it)
+          cartesian_product_invoke(f, *it);
+      }
+    );
+  } else {
+    [&] <std::size_t... I> (std::index_sequence<I...>)
+    {
+      [&] <typename First, typename... Rest>
+        (First const& first, Rest const&... rest)
+      {
+        static_assert(
+          std::ranges::forward_range<First>
+       && (std::ranges::forward_range<Rest> && ...)
+        , "A parallel `for_each` needs bases that are forward ranges."
+        );
+
+        std::vector<std::ranges::iterator_t<First const>> firsts;
+        for (auto it = std::ranges::begin(first);
+             it != std::ranges::end(first); ++it)
+          firsts.push_back(it);
+
+        std::for_each((ExecutionPolicy&&)policy, firsts.begin(), firsts.end()
+        , [&] (auto const& it)
+          {
+            if constexpr (sizeof...(Rest) == 0) {
+              cartesian_product_invoke(
+                f, std::tuple<std::ranges::range_reference_t<First const>>(*it)
+              );
+            } else {
+              for (auto&& e : cartesian_product_view(rest...))
+                cartesian_product_invoke(
+                  f
+                , std::tuple_cat(
+                    std::tuple<std::ranges::range_reference_t<First const>>(*it)
+                  , std::forward<decltype(e)>(e)
+                  )
+                );
+            }
+          }
+        );
+      }(v.template base<0>(), v.template base<I + 1>()...);
+    }(std::make_index_sequence<
+        std::tuple_size_v<std::ranges::range_value_t<decltype(v)>> - 1
+      >{});
+  }
+}
+
+SPACES_END_NAMESPACE
@@ -0,0 +1,190 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+#if defined(__linux__)
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+SPACES_BEGIN_NAMESPACE
+
+enum class performance_counter : index_type
+{
+  cycles
+, instructions
+, branch_misses
+, l1d_misses
+, llc_misses
+, vector_instructions
+};
+
+inline constexpr index_type performance_counter_count = 6;
+
+inline constexpr std::array<char const*, performance_counter_count>
+performance_counter_names = {
+  "cycles"
+, "instructions"
+, "branch_misses"
+, "l1d_misses"
+, "llc_misses"
+, "vector_instructions"
+};
+
+// Counts of each `performance_counter`; NaN if a counter was unavailable.
+using performance_counter_values
+  = std::array<double, performance_counter_count>;
+
+// `performance_counters` - Hardware performance counters for the calling
+// thread, read via Linux `perf_event_open`.
+//
+// Each counter is opened independently, so if the kernel, the hardware or a
+// `perf_event_paranoid` setting refuses some of them, the rest still work; the
+// refused ones read as NaN. On non-Linux platforms every counter is NaN.
+//
+// There is no portable event for vector instructions. Pass the raw,
+// model-specific event encoding as `vector_event` (e.g. `0x10c7` for
+// FP_ARITH_INST_RETIRED.256B_PACKED_DOUBLE on recent Intel cores); if it is
+// zero, that counter is unavailable.
+struct performance_counters
+{
+private:
+  std::array<int, performance_counter_count> fds;
+  std::array<double, performance_counter_count> totals{};
+
+  #if defined(__linux__)
+    static int open_event(std::uint32_t type, std::uint64_t config) noexcept
+    {
+      perf_event_attr attr{};
+      attr.size           = sizeof(attr);
+      attr.type           = type;
+      attr.config         = config;
+      attr.disabled       = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED
+                          | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      return static_cast<int>(
+        syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0)
+      );
+    }
+
+    static constexpr std::uint64_t cache_event(
+      std::uint64_t cache, std::uint64_t op, std::uint64_t result
+    ) noexcept
+    {
+      return cache | (op << 8) | (result << 16);
+    }
+  #endif
+
+public:
+  explicit performance_counters(std::uint64_t vector_event = 0) noexcept
+  {
+    fds.fill(-1);
+
+    #if defined(__linux__)
+      auto at = [&] (performance_counter c) -> int&
+      { return fds[index_type(c)]; };
+
+      at(performance_counter::cycles)
+        = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+      at(performance_counter::instructions)
+        = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+      at(performance_counter::branch_misses)
+        = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+      at(performance_counter::l1d_misses)
+        = open_event(PERF_TYPE_HW_CACHE, cache_event(
+            PERF_COUNT_HW_CACHE_L1D
+          , PERF_COUNT_HW_CACHE_OP_READ
+          , PERF_COUNT_HW_CACHE_RESULT_MISS
+          ));
+      at(performance_counter::llc_misses)
+        = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+      if (vector_event != 0)
+        at(performance_counter::vector_instructions)
+          = open_event(PERF_TYPE_RAW, vector_event);
+    #else
+      (void)vector_event;
+    #endif
+  }
+
+  performance_counters(performance_counters const&) = delete;
+  performance_counters& operator=(performance_counters const&) = delete;
+
+  ~performance_counters()
+  {
+    #if defined(__linux__)
+      for (int fd : fds)
+        if (fd >= 0) close(fd);
+    #endif
+  }
+
+  // Returns true if at least one counter could be opened.
+  bool any_available() const noexcept
+  {
+    for (int fd : fds)
+      if (fd >= 0) return true;
+    return false;
+  }
+
+  // Zeroes the accumulated counts.
+  void clear() noexcept { totals.fill(0.0); }
+
+  // Starts counting. Counts since the last `clear()` keep accumulating.
+  void start() noexcept
+  {
+    #if defined(__linux__)
+      for (int fd : fds)
+        if (fd >= 0) {
+          ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+          ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    #endif
+  }
+
+  // Stops counting and adds the counts since `start()` to the totals, scaled
+  // up if the kernel had to multiplex the counters.
+  void stop() noexcept
+  {
+    #if defined(__linux__)
+      for (int fd : fds)
+        if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+      for (index_type c = 0; c != performance_counter_count; ++c) {
+        if (fds[c] < 0) continue;
+        // value, time enabled, time running.
+        std::uint64_t data[3] = {};
+        if (read(fds[c], data, sizeof(data)) != sizeof(data)) continue;
+        if (data[2] != 0)
+          totals[c] += double(data[0]) * double(data[1]) / double(data[2]);
+      }
+    #endif
+  }
+
+  // Returns the accumulated counts divided by `divisor`, with NaN for
+  // counters that are unavailable.
+  performance_counter_values values(double divisor = 1.0) const noexcept
+  {
+    performance_counter_values v;
+    for (index_type c = 0; c != performance_counter_count; ++c)
+      v[c] = (fds[c] >= 0) ? totals[c] / divisor
+                           : std::numeric_limits<double>::quiet_NaN();
+    return v;
+  }
+};
+
+SPACES_END_NAMESPACE
+
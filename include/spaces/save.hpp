@@ -0,0 +1,116 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/mapped_file.hpp>
+
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#if defined(SPACES_HAS_MAPPED_FILES)
+  #include <sys/uio.h>
+#endif
+
+SPACES_BEGIN_NAMESPACE
+
+namespace detail {
+
+#if defined(SPACES_HAS_MAPPED_FILES)
+
+// Writes all of the `count` buffers of `iov` to `fd`, resuming after short
+// writes (Linux writes at most 2 GiB per call). `iov` is consumed.
+inline bool write_all(int fd, ::iovec* iov, int count) noexcept
+{
+  while (count != 0) {
+    ::ssize_t n = ::writev(fd, iov, count);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    for (; count != 0 && std::size_t(n) >= iov->iov_len; ++iov, --count)
+      n -= iov->iov_len;
+    if (count != 0) {
+      iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+      iov->iov_len -= n;
+    }
+  }
+  return true;
+}
+
+#endif
+
+} // namespace detail
+
+// `save(path, A, alignment)` - Writes `A`, an `mdspan` with a strided layout
+// whose data handle is a pointer, to a file at `path`, creating or truncating
+// it. The file is a `mapped_file_header`, zeros up to the next multiple of
+// `alignment` bytes, a power of 2, and then the `required_span_size()`
+// elements from `A.data_handle()` as they are in memory, so that `load` can
+// map them rather than read them. Layouts with gaps between elements (e.g.
+// padded layouts) are saved with their gaps.
+//
+// The header and the elements are written by one `writev`, without copying
+// the elements. False if the file can't be written; a file that was only
+// partly written is too short for `load` to accept.
+template <typename T, typename Extents, typename Layout, typename Accessor>
+[[nodiscard]] bool save(
+  char const* path
+, mdspan<T, Extents, Layout, Accessor> const& A
+, std::size_t alignment = mapped_file_alignment
+  )
+{
+  static_assert(
+    std::is_same_v<typename Accessor::data_handle_type, T*>
+  , "Only mdspans whose data handles are pointers can be saved."
+  );
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  #if defined(SPACES_HAS_MAPPED_FILES)
+    if (!std::has_single_bit(alignment)) return false;
+
+    auto const h = make_mapped_file_header<T>(A.mapping(), alignment);
+
+    // The header and the padding after it.
+    std::vector<char> head(h.data_offset);
+    std::memcpy(head.data(), &h, sizeof(h));
+
+    ::iovec iov[] = {
+      {head.data(), head.size()}
+    , {const_cast<std::remove_cv_t<T>*>(A.data_handle())
+      , A.mapping().required_span_size() * sizeof(T)}
+    };
+
+    int const fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool const written = detail::write_all(fd, iov, 2);
+    return ::close(fd) == 0 && written;
+  #else
+    return false;
+  #endif
+}
+
+// `load<T, Extents, Layout>(path)` - Maps the file that `save` wrote at
+// `path`, read-only; its `to_mdspan()` views the saved elements where they
+// are in the file. Empty if the file can't be mapped, or if its header
+// doesn't match `T`, the rank and static extents of `Extents` and `Layout`.
+// `layout_stride` matches files saved with any layout.
+template <typename T, typename Extents, typename Layout = layout_right>
+std::optional<mapped_file<T const, Extents, Layout>> load(char const* path)
+{
+  return open_mapped_file<T const, Extents, Layout>(path);
+}
+
+SPACES_END_NAMESPACE
+
@@ -9,6 +9,8 @@
 
 #include <spaces/config.hpp>
 #include <spaces/mdrange.hpp>
+#include <spaces/fused_range.hpp>
+#include <spaces/view_optimization.hpp>
 
 #include <concepts>
 #include <utility>
@@ -16,6 +18,19 @@
 
 SPACES_BEGIN_NAMESPACE
 
+// `fused_mdrange<I>(space, outer)` - Like `mdrange<I>(space, outer)`, but the
+// fusible factories that `space` binds to extent `I` aren't applied to the
+// range. Instead, returns the range they'd be applied to and a stage that
+// applies them to each of its elements in turn. The range that other factories
+// return is rewritten by `optimize_mdrange`.
+//
+// `space` must outlive the result.
+template <index_type I, typename Space, typename OuterTuple>
+constexpr auto fused_mdrange(Space&& space, OuterTuple&& outer)
+{
+  return optimize_mdrange(mdrange<I>((Space&&)space, (OuterTuple&&)outer));
+}
+
 template <typename Space, index_type I, typename Factory>
 struct space_binder
 {
@@ -28,7 +43,7 @@ private:
 public:
   template <typename USpace, typename UFactory>
   constexpr space_binder(USpace&& underlying_, UFactory&& factory_)
-    : underlying((USpace&&)underlying_), factory((UFactory&&)factory) {}
+    : underlying((USpace&&)underlying_), factory((UFactory&&)factory_) {}
 
   constexpr space_binder(space_binder const& other)
     : underlying(other.underlying), factory(other.factory) {}
@@ -50,12 +65,39 @@ public:
         )
       );
     } else {
-      return mdrange<I>(
+      return mdrange<J>(
         std::forward<decltype(space.underlying)>(space.underlying)
       , (OuterTuple&&)outer
       );
     }
   }
+
+  template <index_type J, typename USpace, typename OuterTuple>
+    requires(std::same_as<std::remove_cvref_t<USpace>, space_binder>)
+  friend constexpr auto fused_mdrange(USpace& space, OuterTuple&& outer)
+  {
+    static_assert(J < mdrank<USpace>);
+    if constexpr (I == J && fusible_factory<Factory>) {
+      auto inner = fused_mdrange<J>(space.underlying, (OuterTuple&&)outer);
+      return fused_range{
+        std::move(inner.range)
+      , composed_stage<decltype(inner.stage), Factory const&>{
+          std::move(inner.stage), space.factory
+        }
+      };
+    } else if constexpr (I == J) {
+      return optimize_mdrange(mdrange<J>(space, (OuterTuple&&)outer));
+    } else {
+      return fused_mdrange<J>(space.underlying, (OuterTuple&&)outer);
+    }
+  }
+
+  template <typename USpace, typename UFactory>
+    requires(std::same_as<std::remove_cvref_t<USpace>, space_binder>)
+  friend constexpr auto operator|(USpace&& space, UFactory&& factory)
+  {
+    return space_bind((USpace&&)space, (UFactory&&)factory);
+  }
 };
 
 template <typename Space, index_type I, typename Factory>
@@ -8,63 +8,221 @@
 #pragma once
 
 #include <spaces/config.hpp>
+#include <spaces/fast_divisor.hpp>
 
 #include <array>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
 
 SPACES_BEGIN_NAMESPACE
 
-struct storage_2d_range
+// `storage_md_range<N>` - The indices of a rank `N` space in storage order
+// (the first index varying fastest), tracked by their offset into the space.
+//
+// The iterator keeps both the offset and the indices it decomposes into.
+// Incrementing it bumps the offset and steps the indices like an odometer, so
+// sequential iteration never divides. Random access (`+=`, `[]`) decomposes
+// the new offset with precomputed `fast_divisor`s of the extents, so it never
+// executes a hardware divide either.
+template <index_type N>
+struct storage_md_range
 {
+  static_assert(N != 0, "N must be greater than 0.");
+
   struct iterator
   {
+    using iterator_concept  = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = std::array<index_type, N>;
+    using difference_type   = std::ptrdiff_t;
+
   private:
-    index_type location;
-    std::array<index_type, 2> const extents;
+    index_type location = 0;
+    std::array<index_type, N> indices{};
+    // The extents of all dimensions but the last.
+    std::array<fast_divisor, N - 1> extents{};
+
+    constexpr void decompose() noexcept
+    {
+      index_type l = location;
+      for (index_type d = 0; d != N - 1; ++d) {
+        auto const [q, r] = extents[d].divide_remainder(l);
+        indices[d] = r;
+        l = q;
+      }
+      indices[N - 1] = l;
+    }
+
+    // Called when the first index reaches its extent; propagates the carry to
+    // the outer dimensions.
+    constexpr void carry() noexcept
+    {
+      for (index_type d = 0; d != N - 1; ++d) {
+        if (indices[d] != extents[d].value()) break;
+        indices[d] = 0;
+        ++indices[d + 1];
+      }
+    }
 
   public:
+    constexpr iterator() noexcept = default;
+
     constexpr iterator(
       index_type location_
-    , std::array<index_type, 2> extents_
+    , std::array<fast_divisor, N - 1> const& extents_
     ) noexcept
-      : location(location_), extents{extents_}
-    {}
+      : location(location_), extents(extents_)
+    {
+      decompose();
+    }
 
     constexpr iterator& operator++() noexcept
     {
       ++location;
+      if constexpr (N != 1) {
+        if (++indices[0] == extents[0].value()) [[unlikely]]
+          carry();
+      } else {
+        ++indices[0];
+      }
       return *this;
     }
 
-    constexpr std::array<index_type, 2> operator*() const noexcept
+    constexpr iterator operator++(int) noexcept
     {
-      return std::array{location % extents[0], location / extents[0]};
+      iterator tmp(*this);
+      ++*this;
+      return tmp;
     }
 
-    constexpr bool operator!=(iterator const& other) noexcept
+    constexpr iterator& operator--() noexcept
     {
-      return location != other.location
-          || extents[0] != other.extents[0]
-          || extents[1] != other.extents[1];
+      --location;
+      for (index_type d = 0; d != N - 1; ++d) {
+        if (indices[d] != 0) {
+          --indices[d];
+          return *this;
+        }
+        indices[d] = extents[d].value() - 1;
+      }
+      --indices[N - 1];
+      return *this;
+    }
+
+    constexpr iterator operator--(int) noexcept
+    {
+      iterator tmp(*this);
+      --*this;
+      return tmp;
+    }
+
+    constexpr iterator& operator+=(difference_type d) noexcept
+    {
+      if (d != 0) {
+        location += index_type(d);
+        decompose();
+      }
+      return *this;
+    }
+
+    constexpr iterator& operator-=(difference_type d) noexcept
+    {
+      return *this += -d;
+    }
+
+    friend constexpr iterator operator+(iterator it, difference_type d) noexcept
+    {
+      return it += d;
+    }
+    friend constexpr iterator operator+(difference_type d, iterator it) noexcept
+    {
+      return it += d;
+    }
+
+    friend constexpr iterator operator-(iterator it, difference_type d) noexcept
+    {
+      return it -= d;
+    }
+
+    friend constexpr difference_type
+    operator-(iterator const& l, iterator const& r) noexcept
+    {
+      return difference_type(l.location) - difference_type(r.location);
+    }
+
+    constexpr std::array<index_type, N> operator[](difference_type d)
+      const noexcept
+    {
+      return *(*this + d);
+    }
+
+    constexpr std::array<index_type, N> operator*() const noexcept
+    {
+      return indices;
+    }
+
+    // Compares the indices rather than the offsets, last index first, so
+    // that a loop that only increments and compares iterators doesn't depend
+    // on the offset and compiles to a plain loop nest.
+    friend constexpr bool
+    operator==(iterator const& l, iterator const& r) noexcept
+    {
+      for (index_type d = N; d != 0; --d)
+        if (l.indices[d - 1] != r.indices[d - 1]) return false;
+      return true;
+    }
+
+    friend constexpr std::strong_ordering
+    operator<=>(iterator const& l, iterator const& r) noexcept
+    {
+      return l.location <=> r.location;
     }
   };
 
+  static_assert(std::random_access_iterator<iterator>);
+
 private:
-  iterator const first;
-  iterator const last;
+  iterator first;
+  iterator last;
 
 public:
-  constexpr storage_2d_range(
-      index_type ni
-    , index_type nj
-      ) noexcept
-    : first(index_type(0), std::array<index_type, 2>{ni, nj})
-    , last(ni * nj, std::array<index_type, 2>{ni, nj})
+  constexpr storage_md_range(std::array<index_type, N> extents) noexcept
+  {
+    index_type size = 1;
+    for (auto e : extents) size *= e;
+
+    std::array<fast_divisor, N - 1> divisors;
+    for (index_type d = 0; d != N - 1; ++d)
+      if (extents[d] != 0) divisors[d] = fast_divisor(extents[d]);
+
+    first = iterator(0, divisors);
+    last  = iterator(size, divisors);
+  }
+
+  template <std::convertible_to<index_type>... Extents>
+    requires(sizeof...(Extents) == N)
+  constexpr storage_md_range(Extents... extents) noexcept
+    : storage_md_range(std::array<index_type, N>{index_type(extents)...})
   {}
 
   constexpr iterator begin() const noexcept { return first; }
 
-  constexpr iterator end() const { return last; }
+  constexpr iterator end() const noexcept { return last; }
+
+  constexpr index_type size() const noexcept
+  {
+    return index_type(last - first);
+  }
 };
 
-SPACES_END_NAMESPACE
+template <std::convertible_to<index_type>... Extents>
+storage_md_range(Extents...) -> storage_md_range<sizeof...(Extents)>;
 
+template <index_type N>
+storage_md_range(std::array<index_type, N>) -> storage_md_range<N>;
+
+using storage_2d_range = storage_md_range<2>;
+
+SPACES_END_NAMESPACE
@@ -0,0 +1,410 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+#include <spaces/meta.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/cursor.hpp>
+#include <spaces/zip_for_each.hpp>
+#include <spaces/mapped_file.hpp>
+#include <spaces/huge_page_allocator.hpp>
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+SPACES_BEGIN_NAMESPACE
+
+// `stream_file<T, Extents, Layout>` - An array in a file in the format of
+// `mapped_file`, which `for_each(stream, f, files...)` reads a tile at a time
+// instead of mapping it all, and, if `T` isn't `const`, writes back. The file
+// is closed when the `stream_file` is destroyed.
+//
+// Stream files are opened by `open_stream_file` and created by
+// `create_stream_file`.
+template <typename T, typename Extents, typename Layout = layout_right>
+class stream_file
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+  using element_type = T;
+  using extents_type = Extents;
+  using layout_type = Layout;
+  using mapping_type = typename Layout::template mapping<Extents>;
+
+private:
+  int fd = -1;
+  mapping_type map{};
+  std::uint64_t offset = 0;
+
+  constexpr stream_file(int f, mapping_type const& m, std::uint64_t o) noexcept
+    : fd(f), map(m), offset(o)
+  {}
+
+  template <typename U, typename E, typename L>
+  friend std::optional<stream_file<U, E, L>>
+  open_stream_file(char const* path);
+
+  template <typename U, typename Mapping>
+  friend std::optional<stream_file<
+    U, typename Mapping::extents_type, typename Mapping::layout_type
+  >>
+  create_stream_file(char const* path, Mapping const& m);
+
+public:
+  stream_file(stream_file const&) = delete;
+  stream_file& operator=(stream_file const&) = delete;
+
+  stream_file(stream_file&& other) noexcept
+    : fd(std::exchange(other.fd, -1)), map(other.map), offset(other.offset)
+  {}
+
+  stream_file& operator=(stream_file&& other) noexcept
+  {
+    std::swap(fd, other.fd);
+    std::swap(map, other.map);
+    std::swap(offset, other.offset);
+    return *this;
+  }
+
+  ~stream_file()
+  {
+    #if defined(SPACES_HAS_MAPPED_FILES)
+      if (fd >= 0) ::close(fd);
+    #endif
+  }
+
+  mapping_type const& mapping() const noexcept { return map; }
+
+  int descriptor() const noexcept { return fd; }
+
+  // The offset of the elements in the file, in bytes.
+  std::uint64_t data_offset() const noexcept { return offset; }
+};
+
+// `open_stream_file<T, Extents, Layout>(path)` - Opens the file at `path`,
+// read only if `T` is `const`. Empty if the file can't be opened, or if its
+// header doesn't match, as for `open_mapped_file`.
+template <typename T, typename Extents, typename Layout = layout_right>
+std::optional<stream_file<T, Extents, Layout>>
+open_stream_file(char const* path)
+{
+  #if defined(SPACES_HAS_MAPPED_FILES)
+    using R = stream_file<T, Extents, Layout>;
+
+    int const fd = ::open(path, std::is_const_v<T> ? O_RDONLY : O_RDWR);
+    if (fd < 0) return std::nullopt;
+    // Closes the file if it turns out to be invalid.
+    R file(fd, {}, 0);
+
+    struct ::stat st;
+    mapped_file_header h;
+    if (::fstat(fd, &st) != 0
+     || ::pread(fd, &h, sizeof(h), 0) != sizeof(h))
+      return std::nullopt;
+    auto const m = mapped_file_mapping<T, Extents, Layout>(h, st.st_size);
+    if (!m) return std::nullopt;
+    file.map = *m;
+    file.offset = h.data_offset;
+
+    return std::optional<R>(std::move(file));
+  #else
+    return std::nullopt;
+  #endif
+}
+
+// `create_stream_file<T>(path, mapping)` - Creates a file at `path`, or
+// truncates the file there, that holds an array of `T` with `mapping`, and
+// opens it read-write. The elements are zero. Empty if the file can't be
+// created.
+template <typename T, typename Mapping>
+std::optional<stream_file<
+  T, typename Mapping::extents_type, typename Mapping::layout_type
+>>
+create_stream_file(char const* path, Mapping const& m)
+{
+  #if defined(SPACES_HAS_MAPPED_FILES)
+    using R = stream_file<
+      T, typename Mapping::extents_type, typename Mapping::layout_type
+    >;
+    static_assert(!std::is_const_v<T>);
+
+    auto const h = make_mapped_file_header<T>(m);
+    int const fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return std::nullopt;
+    R file(fd, m, h.data_offset);
+
+    if (::pwrite(fd, &h, sizeof(h), 0) != sizeof(h)
+     || ::ftruncate(fd, h.data_offset + m.required_span_size() * sizeof(T)))
+      return std::nullopt;
+
+    return std::optional<R>(std::move(file));
+  #else
+    return std::nullopt;
+  #endif
+}
+
+// The execution policy of `for_each(stream, f, files...)`.
+struct stream_policy
+{
+  // The size of the tiles of the largest file, which are read and written
+  // whole. Three tiles of each file are in memory at a time.
+  std::size_t tile_bytes = std::size_t(64) << 20;
+};
+
+inline constexpr stream_policy stream{};
+
+namespace detail {
+
+// Reads and writes tiles on a thread of its own, in the order they're
+// submitted.
+class stream_io_queue
+{
+  struct request
+  {
+    int fd;
+    std::byte* buffer;
+    std::size_t bytes;
+    std::uint64_t offset;
+    bool write;
+  };
+
+  std::mutex mutex;
+  std::condition_variable work, done;
+  std::deque<request> requests;
+  std::uint64_t submitted = 0;
+  std::uint64_t completed = 0;
+  bool stopping = false;
+  bool failed = false;
+  std::thread worker;
+
+  static bool transfer(request r) noexcept
+  {
+    #if defined(SPACES_HAS_MAPPED_FILES)
+      while (r.bytes != 0) {
+        auto const n = r.write
+          ? ::pwrite(r.fd, r.buffer, r.bytes, r.offset)
+          : ::pread(r.fd, r.buffer, r.bytes, r.offset);
+        if (n <= 0) return false;
+        r.buffer += n;
+        r.bytes -= n;
+        r.offset += n;
+      }
+      return true;
+    #else
+      return false;
+    #endif
+  }
+
+  void run()
+  {
+    std::unique_lock lock(mutex);
+    while (true) {
+      work.wait(lock, [&] { return stopping || !requests.empty(); });
+      if (requests.empty()) return;
+      request const r = requests.front();
+      requests.pop_front();
+      lock.unlock();
+      bool const ok = transfer(r);
+      lock.lock();
+      failed |= !ok;
+      ++completed;
+      done.notify_all();
+    }
+  }
+
+public:
+  stream_io_queue() : worker([this] { run(); }) {}
+
+  stream_io_queue(stream_io_queue const&) = delete;
+  stream_io_queue& operator=(stream_io_queue const&) = delete;
+
+  // Finishes the requests that were submitted.
+  ~stream_io_queue()
+  {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+    }
+    work.notify_one();
+    worker.join();
+  }
+
+  // Returns a ticket to `wait` for the request with.
+  std::uint64_t submit(
+    int fd, void* buffer, std::size_t bytes, std::uint64_t offset, bool write
+    )
+  {
+    std::uint64_t ticket;
+    {
+      std::lock_guard lock(mutex);
+      requests.push_back(
+        {fd, static_cast<std::byte*>(buffer), bytes, offset, write}
+      );
+      ticket = ++submitted;
+    }
+    work.notify_one();
+    return ticket;
+  }
+
+  // Waits for the request with `ticket`, and those submitted before it.
+  // False if any request has failed.
+  bool wait(std::uint64_t ticket)
+  {
+    std::unique_lock lock(mutex);
+    done.wait(lock, [&] { return completed >= ticket; });
+    return !failed;
+  }
+};
+
+} // namespace detail
+
+// `for_each(stream, f, files...)` - Like `for_each(space, f, arrays...)` over
+// the extents of `files`, `stream_file`s with the same extents and layout,
+// but reads the files a tile of `stream.tile_bytes` at a time. A tile is a
+// run of indices of the slowest varying extent. While `f` runs on one tile,
+// the next is read, and the last is written back to the files whose element
+// type isn't `const`, on another thread. At most three tiles of each file
+// are in memory.
+//
+// Returns false if the extents differ or a tile couldn't be read or written.
+// Once a tile couldn't be read, `f` isn't invoked again and no more tiles are
+// written back.
+template <typename F, typename... Files>
+  requires(sizeof...(Files) != 0
+        && (specialization_of<Files, stream_file> && ...))
+[[nodiscard]] bool for_each(stream_policy policy, F&& f, Files&... files)
+{
+  using First = std::tuple_element_t<0, std::tuple<Files...>>;
+  using Layout = typename First::layout_type;
+  constexpr index_type N = First::extents_type::rank();
+  static_assert(N > 0, "Stream files must have a rank of at least 1.");
+  static_assert(
+    ((Files::extents_type::rank() == N) && ...)
+  , "Every file must have the same rank."
+  );
+  static_assert(
+    (std::is_same_v<typename Files::layout_type, Layout> && ...)
+  , "Every file must have the same layout."
+  );
+  static_assert(
+    std::is_same_v<Layout, layout_left> || std::is_same_v<Layout, layout_right>
+  , "Stream files must have layout_left or layout_right."
+  );
+
+  // Tiles are runs of the slowest varying extent, whose indices are
+  // `slab` elements apart.
+  constexpr index_type slow = std::is_same_v<Layout, layout_left> ? N - 1 : 0;
+  std::array<index_type, N> e{};
+  for (index_type r = 0; r != N; ++r)
+    e[r] = std::get<0>(std::tie(files...)).mapping().extents().extent(r);
+  for (index_type r = 0; r != N; ++r)
+    if (((files.mapping().extents().extent(r) != e[r]) || ...)) return false;
+
+  index_type slab = 1;
+  for (index_type r = 0; r != N; ++r)
+    if (r != slow) slab *= e[r];
+  if (slab == 0 || e[slow] == 0) return true;
+
+  constexpr std::size_t largest
+    = std::max({sizeof(typename Files::element_type)...});
+  index_type const per_tile
+    = std::clamp<index_type>(policy.tile_bytes / (slab * largest), 1, e[slow]);
+  index_type const tiles = (e[slow] + per_tile - 1) / per_tile;
+
+  auto buffers = std::make_tuple(
+    std::array<
+      std::vector<
+        std::remove_const_t<typename Files::element_type>
+      , huge_page_allocator<std::remove_const_t<typename Files::element_type>>
+      >
+    , 3
+    >{}...
+  );
+  // Tiles smaller than a huge page would only waste most of one.
+  huge_page_options const pages{
+    per_tile * slab * largest >= huge_page_size
+      ? huge_pages::transparent : huge_pages::none
+  };
+  std::apply(
+    [&] (auto&... bs) {
+      auto allocate = [&] (auto& b) {
+        using V = std::remove_cvref_t<decltype(b)>;
+        b = V(per_tile * slab, typename V::allocator_type(pages));
+      };
+      for (index_type i = 0; i != 3; ++i) (allocate(bs[i]), ...);
+    }
+  , buffers
+  );
+
+  detail::stream_io_queue io;
+
+  // Submits a request per file to read (or write) tile `k`, from buffer
+  // `k % 3`, and returns the last ticket.
+  auto transfer = [&] (index_type k, bool write) {
+    index_type const slabs = std::min(per_tile, e[slow] - k * per_tile);
+    std::uint64_t ticket = 0;
+    auto submit = [&] (auto& file, auto& b) {
+      using T = typename std::remove_cvref_t<decltype(file)>::element_type;
+      if (write && std::is_const_v<T>) return;
+      ticket = io.submit(
+        file.descriptor(), b[k % 3].data(), slabs * slab * sizeof(T)
+      , file.data_offset() + k * per_tile * slab * sizeof(T), write
+      );
+    };
+    std::apply([&] (auto&... bs) { (submit(files, bs), ...); }, buffers);
+    return ticket;
+  };
+
+  std::array<std::uint64_t, 3> reads{};
+  reads[0] = transfer(0, false);
+  std::uint64_t last = reads[0];
+  for (index_type k = 0; k != tiles; ++k) {
+    // The buffers of tile `k + 1` were last written back from as tile
+    // `k - 2`, which was submitted before this read.
+    if (k + 1 != tiles)
+      last = reads[(k + 1) % 3] = transfer(k + 1, false);
+    if (!io.wait(reads[k % 3])) {
+      // The buffers of tile `k` are stale, so they mustn't be written back.
+      io.wait(last);
+      return false;
+    }
+
+    std::array<index_type, N> te = e;
+    te[slow] = std::min(per_tile, e[slow] - k * per_tile);
+    dextents<N> const tile_extents(te);
+    auto run = [&] (auto&... bs) {
+      for_each(
+        cursor(tile_extents), f
+      , mdspan<
+          typename Files::element_type, dextents<N>, Layout
+        >(bs[k % 3].data(), tile_extents)...
+      );
+    };
+    std::apply(run, buffers);
+
+    if (std::uint64_t w = transfer(k, true)) last = w;
+  }
+
+  return io.wait(last);
+}
+
+SPACES_END_NAMESPACE
+
@@ -8,20 +8,152 @@
 #pragma once
 
 #include <spaces/config.hpp>
+#include <spaces/meta.hpp>
 #include <spaces/views.hpp>
+#include <spaces/fused_range.hpp>
+#include <spaces/extent_range.hpp>
+
+#include <functional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
 
 SPACES_BEGIN_NAMESPACE
 
+// `filter_view_factory<F>` - A fusible factory (see `transform_o_factory`)
+// that filters like `std::views::filter(f)`: `f` is invoked with each element,
+// not with the elements of each element.
+template <typename F>
+struct filter_view_factory
+{
+  static constexpr bool fusible = true;
+
+  F f;
+
+  template <typename Range>
+  constexpr auto operator()(Range&& rng) const
+  {
+    return std::views::filter((Range&&)rng, f);
+  }
+
+  template <typename T, typename Body>
+  constexpr void stage(T&& t, Body&& body) const
+  {
+    if (std::invoke(f, std::as_const(t))) std::invoke(body, (T&&)t);
+  }
+};
+
+template <typename Range>
+constexpr auto optimize_mdrange(Range&& rng);
+
+// True if the base of `Range`, an adaptor, can be taken out of it without
+// moving it out of an lvalue: `Range` is an rvalue, or its base is copyable.
+template <typename Range>
+concept adaptor_base_extractable = requires (Range&& rng) {
+  ((Range&&)rng).base();
+};
+
+// True if `optimize_mdrange` reduces `Range` to a range of the indices of one
+// extent, with no stage.
+template <typename Range>
+concept optimizes_to_extent_bounds = requires (Range&& rng) {
+  { optimize_mdrange((Range&&)rng).stage } -> std::same_as<identity_stage&&>;
+  requires extent_bounds_range<
+    decltype(optimize_mdrange((Range&&)rng).range)
+  >;
+};
+
+// A `take_view`, `drop_view`, `reverse_view` or `stride_view` of a range that
+// `optimize_mdrange` reduces to a range of the indices of one extent.
 template <typename Range>
-auto optimize_range(Range&& rng)
+concept extent_bounds_adaptor
+  = (specialization_of<Range, std::ranges::take_view>
+  || specialization_of<Range, std::ranges::drop_view>
+  || specialization_of<Range, std::ranges::reverse_view>
+  #if defined(__cpp_lib_ranges_stride)
+  || specialization_of<Range, std::ranges::stride_view>
+  #endif
+    )
+  && optimizes_to_extent_bounds<
+       decltype(std::declval<std::remove_cvref_t<Range>>().base())
+     >;
+
+// `optimize_mdrange(rng)` - Rewrites `rng`, a range of the indices of one
+// extent of a space with range adaptors applied to it, into a cheaper range
+// and a stage that applies what's left of the adaptors to each element (see
+// `fused_range`). `for_each` optimizes the range of every extent with it.
+//
+// The rules, tried from the outermost adaptor inwards:
+//
+// * `owning_view` and `ref_view` are unwrapped. Lvalues that they (or the
+//   caller) refer to are never moved or copied out of: adaptors of them are
+//   only unwrapped if their bases are copyable views, and what's left is
+//   referred to by a `ref_view`, so writes through the result still reach
+//   the caller's range.
+// * `filter_view` becomes a stage, applied to the optimized base.
+// * `take_view`, `drop_view`, `reverse_view` and `stride_view` of a range of
+//   the indices of an extent (see `extent_bounds_range`) change its bounds
+//   and step instead, if there's no stage to apply before them.
+// * Anything else, including `transform_view`, whose function isn't
+//   accessible, is left as is. Use `transform_o` to fuse a transformation.
+template <typename Range>
+constexpr auto optimize_mdrange(Range&& rng)
 {
-  return (Range&&)rng;
+  using R = std::remove_cvref_t<Range>;
+
+  if constexpr (specialization_of<R, std::ranges::owning_view>) {
+    return optimize_mdrange(((Range&&)rng).base());
+  } else if constexpr (specialization_of<R, std::ranges::ref_view>) {
+    return optimize_mdrange(rng.base());
+  } else if constexpr (specialization_of<R, std::ranges::filter_view>
+                    && adaptor_base_extractable<Range>) {
+    using F = std::remove_cvref_t<decltype(rng.pred())>;
+    filter_view_factory<F> factory{rng.pred()};
+    auto inner = optimize_mdrange(((Range&&)rng).base());
+    return fused_range{
+      std::move(inner.range)
+    , composed_stage<decltype(inner.stage), filter_view_factory<F>>{
+        std::move(inner.stage), std::move(factory)
+      }
+    };
+  } else if constexpr (extent_bounds_adaptor<R>
+                    && adaptor_base_extractable<Range>) {
+    // The count or stride, which must be read before the base is moved out.
+    index_type n = 0;
+    if constexpr (specialization_of<R, std::ranges::take_view>
+               || specialization_of<R, std::ranges::drop_view>)
+      n = std::ranges::size(rng);
+    #if defined(__cpp_lib_ranges_stride)
+      if constexpr (specialization_of<R, std::ranges::stride_view>)
+        n = rng.stride();
+    #endif
+    auto e = to_extent_range(optimize_mdrange(((Range&&)rng).base()).range);
+    if constexpr (specialization_of<R, std::ranges::take_view>)
+      e = e.take(n);
+    else if constexpr (specialization_of<R, std::ranges::drop_view>)
+      e = e.drop(e.size() - n);
+    else if constexpr (specialization_of<R, std::ranges::reverse_view>)
+      e = e.reverse();
+    #if defined(__cpp_lib_ranges_stride)
+    else
+      e = e.stride(n);
+    #endif
+    return fused_range{std::move(e), identity_stage{}};
+  } else if constexpr (std::is_lvalue_reference_v<Range>
+                    && !(std::ranges::view<R> && std::copy_constructible<R>)) {
+    return fused_range{std::ranges::ref_view(rng), identity_stage{}};
+  } else {
+    return fused_range{R((Range&&)rng), identity_stage{}};
+  }
 }
 
-template <typename Range, typename F>
-auto optimize_range(std::views::filter_view<Range, F> rng)
+// `optimize_range(rng)` - `rng` rewritten by the rules of `optimize_mdrange`,
+// with the stage applied as range adaptors.
+template <typename Range>
+constexpr auto optimize_range(Range&& rng)
 {
-  return filter_o(optimize_range(std::move(rng).base()), std::move(rng).pred());
+  auto [r, stage] = optimize_mdrange((Range&&)rng);
+  return stage.adapt(std::move(r));
 }
 
 SPACES_END_NAMESPACE
@@ -8,13 +8,103 @@
 #pragma once
 
 #include <spaces/config.hpp>
+#include <spaces/meta.hpp>
 #include <spaces/optional.hpp>
 #include <spaces/overloaded.hpp>
 
+#include <functional>
+#include <optional>
 #include <ranges>
+#include <type_traits>
 
 SPACES_BEGIN_NAMESPACE
 
+// `transform_o_factory<F>` - The range adaptor returned by `transform_o(f)`.
+//
+// Besides adapting ranges, `_o` adaptors can be fused: `stage(t, body)` applies
+// the adaptor to a single element `t` and invokes `body` with the result, if
+// there is one, without wrapping it in an `optional`. `for_each` uses this to
+// run a chain of `_o` adaptors as one loop body.
+template <typename F>
+struct transform_o_factory
+{
+  static constexpr bool fusible = true;
+
+  F f;
+
+  template <typename Range>
+  constexpr auto operator()(Range&& rng) const
+  {
+    return std::views::transform(
+      (Range&&)rng
+    , [f = f] <typename T> (T&& t)
+      {
+        return apply_or_invoke_o(f, (T&&)t);
+      }
+    );
+  }
+
+  template <std::ranges::viewable_range Range>
+  friend constexpr auto operator|(Range&& rng, transform_o_factory const& self)
+  {
+    return self((Range&&)rng);
+  }
+
+  template <typename T, typename Body>
+  constexpr void stage(T&& t, Body&& body) const
+  {
+    if constexpr (specialization_of<T, std::optional>) {
+      if (t.has_value()) stage(*((T&&)t), body);
+    } else {
+      std::invoke(body, apply_or_invoke(f, (T&&)t));
+    }
+  }
+};
+
+// `filter_o_factory<F>` - The range adaptor returned by `filter_o(f)`. See
+// `transform_o_factory` for how it's fused.
+template <typename F>
+struct filter_o_factory
+{
+  static constexpr bool fusible = true;
+
+  F f;
+
+  template <typename Range>
+  constexpr auto operator()(Range&& rng) const
+  {
+    return std::views::transform(
+      (Range&&)rng
+    , [f = f] <typename T> (T&& t) -> add_optional<std::remove_cvref_t<T>>
+      {
+        if constexpr (specialization_of<T, std::optional>) {
+          if (t.has_value() && apply_or_invoke(f, *t)) return (T&&)t;
+          else return std::nullopt;
+        } else {
+          if (apply_or_invoke(f, t)) return (T&&)t;
+          else return std::nullopt;
+        }
+      }
+    );
+  }
+
+  template <std::ranges::viewable_range Range>
+  friend constexpr auto operator|(Range&& rng, filter_o_factory const& self)
+  {
+    return self((Range&&)rng);
+  }
+
+  template <typename T, typename Body>
+  constexpr void stage(T&& t, Body&& body) const
+  {
+    if constexpr (specialization_of<T, std::optional>) {
+      if (t.has_value()) stage(*((T&&)t), body);
+    } else {
+      if (apply_or_invoke(f, t)) std::invoke(body, (T&&)t);
+    }
+  }
+};
+
 // `transform_o(rng, f)` or `rng | transform_o(f)` returns a range that, for
 // each element `e` of `rng`, contains a corresponding element that is:
 // * `nullopt` if `e` is an empty `optional`.
@@ -26,47 +116,28 @@ inline constexpr auto transform_o =
 overloaded(
   [] <typename Range, typename F> (Range&& rng, F&& f)
   {
-    return std::views::transform(
-      (Range&&)rng
-    , [f = (F&&)f] <typename T> (T&& t)
-      {
-        return apply_or_invoke_o(f, (T&&)t);
-      }
-    );
+    return transform_o_factory<std::remove_cvref_t<F>>{(F&&)f}((Range&&)rng);
   },
   [] <typename F> (F&& f)
   {
-    return std::views::transform(
-      [f = (F&&)f] <typename T> (T&& t)
-      {
-        return apply_or_invoke_o(f, (T&&)t);
-      }
-    );
+    return transform_o_factory<std::remove_cvref_t<F>>{(F&&)f};
   }
 );
 
+// `filter_o(rng, f)` or `rng | filter_o(f)` returns a range that, for each
+// element `e` of `rng`, contains a corresponding element that is:
+// * `nullopt` if `e` is an empty `optional` or `apply_or_invoke(f, e)` (or
+//   `apply_or_invoke(f, *e)`, if `e` is an `optional`) is false.
+// * `e` otherwise.
 inline constexpr auto filter_o =
 overloaded(
   [] <typename Range, typename F> (Range&& rng, F&& f)
   {
-    return std::views::transform(
-      (Range&&)rng
-    , [f = (F&&)f] <typename T> (T&& t) -> add_optional<T>
-      {
-        if (apply_or_invoke(f, t)) return (T&&)t;
-        else return std::nullopt;
-      }
-    );
+    return filter_o_factory<std::remove_cvref_t<F>>{(F&&)f}((Range&&)rng);
   }
 , [] <typename F> (F&& f)
   {
-    return std::views::transform(
-      [f = (F&&)f] <typename T> (T&& t) -> add_optional<T>
-      {
-        if (apply_or_invoke(f, t)) return (T&&)t;
-        else return std::nullopt;
-      }
-    );
+    return filter_o_factory<std::remove_cvref_t<F>>{(F&&)f};
   }
 );
 
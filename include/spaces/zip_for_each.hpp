@@ -0,0 +1,301 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <spaces/config.hpp>
+#include <spaces/meta.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/cursor.hpp>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+SPACES_BEGIN_NAMESPACE
+
+// The loop nest that `for_each(space, f, arrays...)` runs: loop `K` iterates
+// over `extents[K]` indices of extent `order[K]`, and moves array `A` by
+// `strides[K][A]` elements per index. Loop 0 is the innermost.
+template <index_type N, index_type Arrays>
+struct zip_traversal
+{
+  std::array<index_type, N> order;
+  std::array<index_type, N> extents;
+  std::array<std::array<index_type, Arrays>, N> strides;
+
+  // True if every array is contiguous along the innermost loop.
+  constexpr bool contiguous() const noexcept
+  {
+    for (index_type a = 0; a != Arrays; ++a)
+      if (strides[0][a] != 1) return false;
+    return true;
+  }
+};
+
+// `zip_traversal_order(space, arrays...)` - Picks the order of the loops over
+// the extents of `space` that touches the least memory with a stride. The
+// extents are nested by the bytes that all of the arrays move per index,
+// smallest innermost; ties keep the order that `for_each` uses, with the
+// first extent innermost.
+template <index_type N, typename... Arrays>
+constexpr zip_traversal<N, sizeof...(Arrays)>
+zip_traversal_order(cursor<N> const& space, Arrays const&... arrays) noexcept
+{
+  std::array<index_type, N> cost{};
+  for (index_type d = 0; d != N; ++d)
+    cost[d] = (index_type(0) + ...
+      + (arrays.stride(d) * sizeof(typename Arrays::element_type)));
+
+  zip_traversal<N, sizeof...(Arrays)> t{};
+  for (index_type k = 0; k != N; ++k) {
+    // Insertion sort, as `N` is small.
+    index_type j = k;
+    for (; j != 0 && cost[t.order[j - 1]] > cost[k]; --j)
+      t.order[j] = t.order[j - 1];
+    t.order[j] = k;
+  }
+
+  for (index_type k = 0; k != N; ++k) {
+    t.extents[k] = space.extents()[t.order[k]];
+    t.strides[k] = {index_type(arrays.stride(t.order[k]))...};
+  }
+
+  return t;
+}
+
+// An accessor policy that can be told how the elements it accesses will be
+// traversed, like `mapped_accessor`: `a.advise_sequential(p, n)` says that
+// the `n` elements at `p` will be traversed in order, and
+// `a.advise_will_need(p, n)` that they'll be traversed soon.
+template <typename Accessor>
+concept advisable_accessor = requires (
+  Accessor const& a, typename Accessor::data_handle_type p, std::size_t n
+) {
+  a.advise_sequential(p, n);
+  a.advise_will_need(p, n);
+};
+
+template <typename... Arrays>
+inline constexpr bool zip_advises
+  = (advisable_accessor<typename Arrays::accessor_type> || ...);
+
+// How far ahead of the outermost loop `for_each(space, f, arrays...)` asks
+// for the elements of arrays with an `advisable_accessor`, in bytes.
+inline constexpr index_type zip_readahead_bytes = index_type(1) << 20;
+
+// The number of iterations of the outermost loop, whose strides are
+// `strides`, that move the advisable arrays by `zip_readahead_bytes`.
+template <typename... Arrays, std::size_t... A>
+constexpr index_type zip_readahead_window(
+  std::index_sequence<A...>
+, std::array<index_type, sizeof...(Arrays)> const& strides
+, Arrays const&...
+  ) noexcept
+{
+  index_type slice = 1;
+  ((slice = advisable_accessor<typename Arrays::accessor_type>
+    ? std::max(slice, strides[A] * sizeof(typename Arrays::element_type))
+    : slice), ...);
+  return std::max(zip_readahead_bytes / slice, index_type(1));
+}
+
+// Advises the advisable arrays that `n` iterations of the outermost loop,
+// whose strides are `strides`, starting at `offsets`, will run soon.
+template <typename... Arrays, std::size_t... A>
+void zip_advise_will_need(
+  std::index_sequence<A...>
+, index_type n
+, std::array<index_type, sizeof...(Arrays)> const& offsets
+, std::array<index_type, sizeof...(Arrays)> const& strides
+, Arrays const&... arrays
+  ) noexcept
+{
+  auto advise = [&] (index_type offset, index_type stride, auto const& array)
+  {
+    using Array = std::remove_cvref_t<decltype(array)>;
+    if constexpr (advisable_accessor<typename Array::accessor_type>) {
+      index_type const span = array.mapping().required_span_size();
+      if (offset < span)
+        array.accessor().advise_will_need(
+          array.data_handle() + offset, std::min(n * stride, span - offset)
+        );
+    }
+  };
+  (advise(offsets[A], strides[A], arrays), ...);
+}
+
+template <typename F, typename... Arrays, std::size_t... A>
+constexpr void zip_for_each_contiguous_loop(
+  std::index_sequence<A...>
+, F& f
+, index_type n
+, std::array<index_type, sizeof...(Arrays)> const& offsets
+, Arrays const&... arrays
+  )
+{
+  SPACES_DEMAND_VECTORIZATION
+  for (index_type i = 0; i != n; ++i)
+    std::invoke(
+      f, arrays.accessor().access(arrays.data_handle(), offsets[A] + i)...
+    );
+}
+
+template <typename F, typename... Arrays, std::size_t... A>
+constexpr void zip_for_each_strided_loop(
+  std::index_sequence<A...>
+, F& f
+, index_type n
+, std::array<index_type, sizeof...(Arrays)> const& offsets
+, std::array<index_type, sizeof...(Arrays)> const& strides
+, Arrays const&... arrays
+  )
+{
+  SPACES_DEMAND_VECTORIZATION
+  for (index_type i = 0; i != n; ++i)
+    std::invoke(
+      f
+    , arrays.accessor().access(
+        arrays.data_handle(), offsets[A] + i * strides[A]
+      )...
+    );
+}
+
+// Runs loop `K` of `t` and the loops inside it, starting at `offsets` into
+// each array.
+template <index_type K, index_type N, typename F, typename... Arrays>
+constexpr void zip_for_each_impl(
+  zip_traversal<N, sizeof...(Arrays)> const& t
+, F& f
+, std::array<index_type, sizeof...(Arrays)> offsets
+, Arrays const&... arrays
+  )
+{
+  constexpr auto A = std::index_sequence_for<Arrays...>{};
+
+  if constexpr (K == 0) {
+    if (t.contiguous())
+      zip_for_each_contiguous_loop(A, f, t.extents[0], offsets, arrays...);
+    else
+      zip_for_each_strided_loop(
+        A, f, t.extents[0], offsets, t.strides[0], arrays...
+      );
+  } else {
+    for (index_type i = 0; i != t.extents[K]; ++i) {
+      zip_for_each_impl<K - 1>(t, f, offsets, arrays...);
+      for (index_type a = 0; a != sizeof...(Arrays); ++a)
+        offsets[a] += t.strides[K][a];
+    }
+  }
+}
+
+// Runs the loops of `t` like `zip_for_each_impl`, advising the advisable
+// arrays that they're traversed in order, and asking for the next window of
+// iterations of the outermost loop as each window starts.
+template <index_type N, typename F, typename... Arrays>
+void zip_for_each_advised(
+  zip_traversal<N, sizeof...(Arrays)> const& t
+, F& f
+, Arrays const&... arrays
+  )
+{
+  constexpr auto A = std::index_sequence_for<Arrays...>{};
+  constexpr index_type K = N - 1;
+
+  auto advise_sequential = [] (auto const& array)
+  {
+    using Array = std::remove_cvref_t<decltype(array)>;
+    if constexpr (advisable_accessor<typename Array::accessor_type>)
+      array.accessor().advise_sequential(
+        array.data_handle(), array.mapping().required_span_size()
+      );
+  };
+  (advise_sequential(arrays), ...);
+
+  index_type const w = zip_readahead_window(A, t.strides[K], arrays...);
+  std::array<index_type, sizeof...(Arrays)> offsets{};
+  zip_advise_will_need(A, w, offsets, t.strides[K], arrays...);
+  for (index_type i = 0; i != t.extents[K]; ++i) {
+    if (i % w == 0) {
+      auto next = offsets;
+      for (index_type a = 0; a != sizeof...(Arrays); ++a)
+        next[a] += w * t.strides[K][a];
+      zip_advise_will_need(A, w, next, t.strides[K], arrays...);
+    }
+    zip_for_each_impl<K - 1>(t, f, offsets, arrays...);
+    for (index_type a = 0; a != sizeof...(Arrays); ++a)
+      offsets[a] += t.strides[K][a];
+  }
+}
+
+// True if any advisable array spans more than `zip_readahead_bytes`. Smaller
+// arrays are left to the kernel's own readahead.
+template <typename... Arrays>
+bool zip_worth_advising(Arrays const&... arrays) noexcept
+{
+  auto large = [] (auto const& array)
+  {
+    using Array = std::remove_cvref_t<decltype(array)>;
+    if constexpr (advisable_accessor<typename Array::accessor_type>)
+      return array.mapping().required_span_size()
+           * sizeof(typename Array::element_type) > zip_readahead_bytes;
+    else
+      return false;
+  };
+  return (large(arrays) || ...);
+}
+
+// `for_each(space, f, arrays...)` - For each index `(i, j, ...)` of `space`, a
+// `cursor`, invokes `f(arrays(i, j, ...)...)`, passing `f` a reference to the
+// element of every array at that index.
+//
+// Instead of the order that `for_each(space, f)` uses, the loops are nested in
+// the order picked by `zip_traversal_order`, so `f` must not depend on the
+// order in which it's invoked. If every array is contiguous along the
+// innermost loop, it indexes them directly; otherwise, it steps through them
+// by their strides. Either way, it's vectorized as if no array overlapped
+// another at a different index.
+//
+// Arrays with an `advisable_accessor`, like those of a `mapped_file`, are
+// advised that they'll be traversed in order, and, a window of
+// `zip_readahead_bytes` at a time, which elements the outermost loop will
+// touch next, so that their pages are read in while `f` runs. Unless one of
+// them spans more than a window, or `space` has rank 1, no advice is given.
+//
+// The arrays must be strided `mdspan`s with the rank of `space` and extents
+// no smaller than its extents.
+template <index_type N, typename F, typename... Arrays>
+  requires(sizeof...(Arrays) != 0 && (specialization_of<Arrays, mdspan> && ...))
+constexpr void for_each(cursor<N> const& space, F&& f, Arrays const&... arrays)
+{
+  static_assert(
+    ((Arrays::rank() == N) && ...)
+  , "Every array must have the rank of the space."
+  );
+  static_assert(
+    (Arrays::mapping_type::is_always_strided() && ...)
+  , "Every array must have a strided layout."
+  );
+
+  if constexpr (N > 0) {
+    auto const t = zip_traversal_order(space, arrays...);
+    for (index_type k = 0; k != N; ++k)
+      if (t.extents[k] == 0) return;
+    if constexpr (N > 1 && zip_advises<Arrays...>)
+      if (zip_worth_advising(arrays...))
+        return zip_for_each_advised(t, f, arrays...);
+    zip_for_each_impl<N - 1>(t, f, {}, arrays...);
+  } else {
+    std::invoke(f, arrays()...);
+  }
+}
+
+SPACES_END_NAMESPACE
+
@@ -0,0 +1,147 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/huge_page_allocator.hpp>
+#include <spaces/test.hpp>
+#include <spaces/benchmark.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <memory>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+using input_2d
+  = spaces::mdspan<double const, spaces::dextents<2>, spaces::layout_left>;
+using output_2d
+  = spaces::mdspan<double, spaces::dextents<2>, spaces::layout_stride>;
+
+extern void add_2d_reference(
+  double const* __restrict__ A
+, double const* __restrict__ B
+, double* __restrict__ C
+, spaces::index_type N
+, spaces::index_type M
+  ) noexcept;
+
+extern void add_2d_space_based_for_each(input_2d A, input_2d B, output_2d C);
+
+extern void add_2d_for_each_zip(input_2d A, input_2d B, output_2d C);
+
+extern void add_2d_for_each_zip_transposed(
+  input_2d A, input_2d B, output_2d C
+);
+
+void set_to_initial_state(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+, spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> B
+, output_2d C
+) {
+  for (spaces::index_type j = 0; j != A.extent(1); ++j)
+    for (spaces::index_type i = 0; i != A.extent(0); ++i) {
+      A(i, j) = A.mapping()(i, j);
+      B(i, j) = 2.0 * A.mapping()(i, j);
+      C(i, j) = -1.0;
+    }
+}
+
+void validate_state(input_2d A, output_2d C) {
+  for (spaces::index_type j = 0; j != A.extent(1); ++j)
+    for (spaces::index_type i = 0; i != A.extent(0); ++i)
+      SPACES_TEST_EQ(C(i, j), 3.0 * A.mapping()(i, j));
+}
+
+using add_2d_kernel = void (*)(input_2d, input_2d, output_2d);
+
+struct named_add_2d_kernel
+{
+  char const* name;
+  add_2d_kernel kernel;
+};
+
+named_add_2d_kernel const kernels[] = {
+  {"add_2d_reference",
+    [] (input_2d A, input_2d B, output_2d C)
+    {
+      add_2d_reference(
+        A.data_handle(), B.data_handle(), C.data_handle()
+      , A.extent(0), A.extent(1)
+      );
+    }}
+, {"add_2d_space_based_for_each",
+    add_2d_space_based_for_each}
+, {"add_2d_for_each_zip",
+    add_2d_for_each_zip}
+, {"add_2d_for_each_zip_transposed",
+    add_2d_for_each_zip_transposed}
+};
+
+// `--sizes=N,...` runs the kernels on N x N arrays. N must be a multiple of
+// 32, as the reference kernel assumes. `--sweep` picks such N so that the
+// footprints double from the L1 cache to main memory. The inputs are column
+// major and the output is a `layout_stride` view of a row major array, as the
+// reference kernel assumes, so that `for_each(space, f, arrays...)` has to
+// step through the output by its stride.
+int main(int argc, char** argv) {
+  auto const options = spaces::parse_benchmark_options(argc, argv);
+
+#if defined(SPACES_BENCHMARK)
+  std::vector<spaces::benchmark_result> results;
+#endif
+
+  for (spaces::index_type N :
+       options.extents_for(2, 3 * sizeof(double), 32, 128)) {
+    if (N % 32 != 0) {
+      std::cerr << "error: size " << N << " is not a multiple of 32\n";
+      return 1;
+    }
+    spaces::index_type const M = N;
+
+    auto allocate = [&] (auto const& mapping) {
+      return spaces::make_huge_page_mdarray<double>(mapping);
+    };
+    auto a = allocate(spaces::layout_left::mapping{spaces::extents{N, M}});
+    auto b = allocate(spaces::layout_left::mapping{spaces::extents{N, M}});
+    auto c = allocate(
+      spaces::layout_stride::mapping{
+        spaces::dextents<2>{N, M}, std::array<spaces::index_type, 2>{M, 1}
+      }
+    );
+
+    spaces::mdspan A = a.to_mdspan();
+    spaces::mdspan B = b.to_mdspan();
+    output_2d C = c.to_mdspan();
+
+    for (auto [name, kernel] : kernels) {
+      set_to_initial_state(A, B, C);
+      kernel(A, B, C);
+      validate_state(A, C);
+    }
+
+#if defined(SPACES_BENCHMARK)
+    spaces::benchmark_kernels(
+      results, kernels, {A.extent(0), A.extent(1)}
+    , 3 * A.extent(0) * A.extent(1) * sizeof(double)
+    , [&] { set_to_initial_state(A, B, C); }
+    , [&] (auto kernel) { kernel(A, B, C); }
+    , options
+    );
+#endif
+  }
+
+#if defined(SPACES_BENCHMARK)
+  if (!spaces::report_benchmarks("add_2d", "add_2d_reference", results, options))
+    return 1;
+#endif
+
+  return spaces::test_report_errors();
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/cursor.hpp>
+#include <spaces/zip_for_each.hpp>
+
+#include <array>
+#include <type_traits>
+
+// Adds the transposes of `A` and `B` into the transpose of `C`, whose first
+// extent is the one that the arrays move the furthest along, so
+// `for_each(space, f, arrays...)` has to reorder the loops to traverse them in
+// memory order.
+void add_2d_for_each_zip_transposed(
+  spaces::mdspan<double const, spaces::dextents<2>, spaces::layout_left> A
+, spaces::mdspan<double const, spaces::dextents<2>, spaces::layout_left> B
+, spaces::mdspan<double, spaces::dextents<2>, spaces::layout_stride> C
+  ) noexcept
+{
+  auto transpose = [] (auto const& X)
+  {
+    using T = typename std::remove_cvref_t<decltype(X)>::element_type;
+    return spaces::mdspan<T, spaces::dextents<2>, spaces::layout_stride>(
+      X.data_handle()
+    , spaces::layout_stride::mapping{
+        spaces::dextents<2>{X.extent(1), X.extent(0)}
+      , std::array<spaces::index_type, 2>{X.stride(1), X.stride(0)}
+      }
+    );
+  };
+
+  spaces::for_each(
+    spaces::cursor<2>(A.extent(1), A.extent(0))
+  , [] (double a, double b, double& c) { c = a + b; }
+  , transpose(A), transpose(B), transpose(C)
+  );
+}
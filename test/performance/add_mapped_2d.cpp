@@ -0,0 +1,168 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/mapped_file.hpp>
+#include <spaces/save.hpp>
+#include <spaces/test.hpp>
+#include <spaces/benchmark.hpp>
+
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using input_2d = spaces::mdspan<
+  double const, spaces::dextents<2>, spaces::layout_left
+, spaces::mapped_accessor<double const>
+>;
+using output_2d = spaces::mdspan<
+  double, spaces::dextents<2>, spaces::layout_left
+, spaces::mapped_accessor<double>
+>;
+
+extern void add_mapped_2d_reference(
+  double const* __restrict__ A
+, double const* __restrict__ B
+, double* __restrict__ C
+, spaces::index_type N
+, spaces::index_type M
+  ) noexcept;
+
+extern void add_mapped_2d_for_each_zip(input_2d A, input_2d B, output_2d C);
+
+void set_to_initial_state(output_2d C) {
+  for (spaces::index_type j = 0; j != C.extent(1); ++j)
+    for (spaces::index_type i = 0; i != C.extent(0); ++i)
+      C(i, j) = -1.0;
+}
+
+void validate_state(input_2d A, input_2d B, output_2d C) {
+  for (spaces::index_type j = 0; j != A.extent(1); ++j)
+    for (spaces::index_type i = 0; i != A.extent(0); ++i) {
+      SPACES_TEST_EQ(A(i, j), A.mapping()(i, j));
+      SPACES_TEST_EQ(B(i, j), 2.0 * A.mapping()(i, j));
+      SPACES_TEST_EQ(C(i, j), 3.0 * A.mapping()(i, j));
+    }
+}
+
+using add_mapped_2d_kernel = void (*)(input_2d, input_2d, output_2d);
+
+struct named_add_mapped_2d_kernel
+{
+  char const* name;
+  add_mapped_2d_kernel kernel;
+};
+
+named_add_mapped_2d_kernel const kernels[] = {
+  {"add_mapped_2d_reference",
+    [] (input_2d A, input_2d B, output_2d C)
+    {
+      add_mapped_2d_reference(
+        A.data_handle(), B.data_handle(), C.data_handle()
+      , A.extent(0), A.extent(1)
+      );
+    }}
+, {"add_mapped_2d_for_each_zip",
+    add_mapped_2d_for_each_zip}
+};
+
+// `--sizes=N,...` runs the kernels on N x N arrays. N must be a multiple of
+// 32, as the reference kernel assumes. `--sweep` picks such N so that the
+// footprints double from the L1 cache to main memory. Every array is a
+// column major `mapped_file` in the temporary directory; the inputs are
+// written by `spaces::save`, and then mapped by `spaces::load`.
+int main(int argc, char** argv) {
+  auto const options = spaces::parse_benchmark_options(argc, argv);
+
+#if defined(SPACES_BENCHMARK)
+  std::vector<spaces::benchmark_result> results;
+#endif
+
+  auto const prefix = std::filesystem::temp_directory_path()
+    / ("spaces_add_mapped_2d_" + std::to_string(::getpid()) + "_");
+
+  for (spaces::index_type N :
+       options.extents_for(2, 3 * sizeof(double), 32, 128)) {
+    if (N % 32 != 0) {
+      std::cerr << "error: size " << N << " is not a multiple of 32\n";
+      return 1;
+    }
+    spaces::index_type const M = N;
+
+    spaces::layout_left::mapping const map{spaces::extents{N, M}};
+    std::string const paths[] = {
+      prefix.string() + "A", prefix.string() + "B", prefix.string() + "C"
+    };
+
+    {
+      std::vector<double> a(N * M), b(N * M);
+      spaces::mdspan A(a.data(), map);
+      spaces::mdspan B(b.data(), map);
+      for (spaces::index_type j = 0; j != M; ++j)
+        for (spaces::index_type i = 0; i != N; ++i) {
+          A(i, j) = map(i, j);
+          B(i, j) = 2.0 * map(i, j);
+        }
+      if (!spaces::save(paths[0].c_str(), A)
+       || !spaces::save(paths[1].c_str(), B)) {
+        std::cerr << "error: can't save " << paths[0] << "\n";
+        return 1;
+      }
+    }
+
+    auto a = spaces::load<double, spaces::dextents<2>, spaces::layout_left>(
+      paths[0].c_str()
+    );
+    auto b = spaces::load<double, spaces::dextents<2>, spaces::layout_left>(
+      paths[1].c_str()
+    );
+    auto c = spaces::create_mapped_file<double>(paths[2].c_str(), map);
+    for (auto const& path : paths) std::filesystem::remove(path);
+    if (!a || !b || !c) {
+      std::cerr << "error: can't map " << paths[0] << "\n";
+      return 1;
+    }
+
+    input_2d A = a->to_mdspan();
+    input_2d B = b->to_mdspan();
+    output_2d C = c->to_mdspan();
+    SPACES_TEST_EQ(A.extent(0), N);
+    SPACES_TEST_EQ(A.extent(1), M);
+
+    for (auto [name, kernel] : kernels) {
+      set_to_initial_state(C);
+      kernel(A, B, C);
+      validate_state(A, B, C);
+    }
+
+#if defined(SPACES_BENCHMARK)
+    spaces::benchmark_kernels(
+      results, kernels, {A.extent(0), A.extent(1)}
+    , 3 * A.extent(0) * A.extent(1) * sizeof(double)
+    , [&] { set_to_initial_state(C); }
+    , [&] (auto kernel) { kernel(A, B, C); }
+    , options
+    );
+#endif
+  }
+
+#if defined(SPACES_BENCHMARK)
+  if (!spaces::report_benchmarks(
+        "add_mapped_2d", "add_mapped_2d_reference", results, options
+      ))
+    return 1;
+#endif
+
+  return spaces::test_report_errors();
+}
@@ -0,0 +1,34 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/mapped_file.hpp>
+#include <spaces/cursor.hpp>
+#include <spaces/zip_for_each.hpp>
+
+void add_mapped_2d_for_each_zip(
+  spaces::mdspan<
+    double const, spaces::dextents<2>, spaces::layout_left
+  , spaces::mapped_accessor<double const>
+  > A
+, spaces::mdspan<
+    double const, spaces::dextents<2>, spaces::layout_left
+  , spaces::mapped_accessor<double const>
+  > B
+, spaces::mdspan<
+    double, spaces::dextents<2>, spaces::layout_left
+  , spaces::mapped_accessor<double>
+  > C
+  ) noexcept
+{
+  spaces::for_each(
+    spaces::cursor(A.extents())
+  , [] (double a, double b, double& c) { c = a + b; }
+  , A, B, C
+  );
+}
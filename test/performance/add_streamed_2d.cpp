@@ -0,0 +1,179 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/mapped_file.hpp>
+#include <spaces/stream_for_each.hpp>
+#include <spaces/test.hpp>
+#include <spaces/benchmark.hpp>
+
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using input_file = spaces::stream_file<
+  double const, spaces::dextents<2>, spaces::layout_left
+>;
+using output_file
+  = spaces::stream_file<double, spaces::dextents<2>, spaces::layout_left>;
+
+extern bool add_streamed_2d_reference(
+  input_file& A, input_file& B, output_file& C
+);
+
+extern bool add_streamed_2d_for_each_stream(
+  input_file& A, input_file& B, output_file& C
+);
+
+// The kernels write `C` through its file, so it's mapped to be checked.
+void set_to_initial_state(char const* path) {
+  auto c = spaces::open_mapped_file<
+    double, spaces::dextents<2>, spaces::layout_left
+  >(path);
+  SPACES_TEST(c.has_value());
+  if (!c) return;
+  auto C = c->to_mdspan();
+  for (spaces::index_type j = 0; j != C.extent(1); ++j)
+    for (spaces::index_type i = 0; i != C.extent(0); ++i)
+      C(i, j) = -1.0;
+}
+
+void validate_state(char const* path) {
+  auto c = spaces::open_mapped_file<
+    double const, spaces::dextents<2>, spaces::layout_left
+  >(path);
+  SPACES_TEST(c.has_value());
+  if (!c) return;
+  auto C = c->to_mdspan();
+  for (spaces::index_type j = 0; j != C.extent(1); ++j)
+    for (spaces::index_type i = 0; i != C.extent(0); ++i)
+      SPACES_TEST_EQ(C(i, j), 3.0 * C.mapping()(i, j));
+}
+
+// Checks that the columns of `C` from `j0` on weren't written.
+void validate_untouched_state(char const* path, spaces::index_type j0) {
+  auto c = spaces::open_mapped_file<
+    double const, spaces::dextents<2>, spaces::layout_left
+  >(path);
+  SPACES_TEST(c.has_value());
+  if (!c) return;
+  auto C = c->to_mdspan();
+  for (spaces::index_type j = j0; j != C.extent(1); ++j)
+    for (spaces::index_type i = 0; i != C.extent(0); ++i)
+      SPACES_TEST_EQ(C(i, j), -1.0);
+}
+
+using add_streamed_2d_kernel = bool (*)(input_file&, input_file&, output_file&);
+
+struct named_add_streamed_2d_kernel
+{
+  char const* name;
+  add_streamed_2d_kernel kernel;
+};
+
+named_add_streamed_2d_kernel const kernels[] = {
+  {"add_streamed_2d_reference",
+    add_streamed_2d_reference}
+, {"add_streamed_2d_for_each_stream",
+    add_streamed_2d_for_each_stream}
+};
+
+// `--sizes=N,...` runs the kernels on N x N arrays. `--sweep` picks N so
+// that the footprints double from the L1 cache to main memory. Every array is
+// a column major `stream_file` in the temporary directory, which the kernels
+// read and write rather than map.
+int main(int argc, char** argv) {
+  auto const options = spaces::parse_benchmark_options(argc, argv);
+
+#if defined(SPACES_BENCHMARK)
+  std::vector<spaces::benchmark_result> results;
+#endif
+
+  auto const prefix = std::filesystem::temp_directory_path()
+    / ("spaces_add_streamed_2d_" + std::to_string(::getpid()) + "_");
+
+  for (spaces::index_type N :
+       options.extents_for(2, 3 * sizeof(double), 32, 128)) {
+    spaces::index_type const M = N;
+
+    spaces::layout_left::mapping const map{spaces::extents{N, M}};
+    std::string const paths[] = {
+      prefix.string() + "A", prefix.string() + "B", prefix.string() + "C"
+    };
+
+    {
+      auto a = spaces::create_mapped_file<double>(paths[0].c_str(), map);
+      auto b = spaces::create_mapped_file<double>(paths[1].c_str(), map);
+      if (!a || !b) {
+        std::cerr << "error: can't create " << paths[0] << "\n";
+        return 1;
+      }
+      auto A = a->to_mdspan();
+      auto B = b->to_mdspan();
+      for (spaces::index_type j = 0; j != M; ++j)
+        for (spaces::index_type i = 0; i != N; ++i) {
+          A(i, j) = map(i, j);
+          B(i, j) = 2.0 * map(i, j);
+        }
+    }
+
+    auto a = spaces::open_stream_file<
+      double const, spaces::dextents<2>, spaces::layout_left
+    >(paths[0].c_str());
+    auto b = spaces::open_stream_file<
+      double const, spaces::dextents<2>, spaces::layout_left
+    >(paths[1].c_str());
+    auto c = spaces::create_stream_file<double>(paths[2].c_str(), map);
+    if (!a || !b || !c) {
+      std::cerr << "error: can't open " << paths[0] << "\n";
+      return 1;
+    }
+
+    for (auto [name, kernel] : kernels) {
+      set_to_initial_state(paths[2].c_str());
+      SPACES_TEST(kernel(*a, *b, *c));
+      validate_state(paths[2].c_str());
+    }
+
+#if defined(SPACES_BENCHMARK)
+    spaces::benchmark_kernels(
+      results, kernels, {N, M}
+    , 3 * N * M * sizeof(double)
+    , [&] {}
+    , [&] (auto kernel) { kernel(*a, *b, *c); }
+    , options
+    );
+#endif
+
+    // If `A` is truncated, the tiles past its end can't be read, and stale
+    // tiles mustn't be written back over `C`.
+    set_to_initial_state(paths[2].c_str());
+    std::filesystem::resize_file(
+      paths[0], a->data_offset() + (M / 2) * N * sizeof(double)
+    );
+    SPACES_TEST(!add_streamed_2d_for_each_stream(*a, *b, *c));
+    validate_untouched_state(paths[2].c_str(), M / 2);
+
+    for (auto const& path : paths) std::filesystem::remove(path);
+  }
+
+#if defined(SPACES_BENCHMARK)
+  if (!spaces::report_benchmarks(
+        "add_streamed_2d", "add_streamed_2d_reference", results, options
+      ))
+    return 1;
+#endif
+
+  return spaces::test_report_errors();
+}
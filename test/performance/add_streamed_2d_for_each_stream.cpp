@@ -0,0 +1,25 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/stream_for_each.hpp>
+
+bool add_streamed_2d_for_each_stream(
+  spaces::stream_file<double const, spaces::dextents<2>, spaces::layout_left>& A
+, spaces::stream_file<double const, spaces::dextents<2>, spaces::layout_left>& B
+, spaces::stream_file<double, spaces::dextents<2>, spaces::layout_left>& C
+  )
+{
+  // Small tiles, so that even small arrays are streamed in several: at
+  // 128 x 128, five of 24 columns and a partial one of 8.
+  return spaces::for_each(
+    spaces::stream_policy{std::size_t(24) << 10}
+  , [] (double a, double b, double& c) { c = a + b; }
+  , A, B, C
+  );
+}
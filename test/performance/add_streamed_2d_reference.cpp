@@ -0,0 +1,57 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/stream_for_each.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <unistd.h>
+
+using input_file = spaces::stream_file<
+  double const, spaces::dextents<2>, spaces::layout_left
+>;
+using output_file
+  = spaces::stream_file<double, spaces::dextents<2>, spaces::layout_left>;
+
+static bool transfer(
+  bool write, int fd, double* p, std::size_t n, std::uint64_t offset
+  ) noexcept
+{
+  auto* b = reinterpret_cast<char*>(p);
+  std::size_t bytes = n * sizeof(double);
+  while (bytes != 0) {
+    auto const r = write
+      ? ::pwrite(fd, b, bytes, offset) : ::pread(fd, b, bytes, offset);
+    if (r <= 0) return false;
+    b += r;
+    bytes -= r;
+    offset += r;
+  }
+  return true;
+}
+
+// Reads all of `A` and `B` into memory, adds them, and then writes all of
+// `C`.
+bool add_streamed_2d_reference(input_file& A, input_file& B, output_file& C)
+{
+  spaces::index_type const N = A.mapping().extents().extent(0);
+  spaces::index_type const M = A.mapping().extents().extent(1);
+  std::vector<double> a(N * M), b(N * M), c(N * M);
+  if (!transfer(false, A.descriptor(), a.data(), N * M, A.data_offset())
+   || !transfer(false, B.descriptor(), b.data(), N * M, B.data_offset()))
+    return false;
+
+  SPACES_DEMAND_VECTORIZATION
+  for (spaces::index_type i = 0; i != N * M; ++i)
+    c[i] = a[i] + b[i];
+
+  return transfer(true, C.descriptor(), c.data(), N * M, C.data_offset());
+}
@@ -0,0 +1,346 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// benchmark_compare - Diffs two JSON files written by the `bench.performance.*`
+// drivers (`--json=FILE`) and exits with a nonzero status if any kernel in the
+// candidate file got slower than in the baseline file.
+//
+// Usage: benchmark_compare [--threshold=R] [--alpha=P] BASELINE CANDIDATE
+//
+// A kernel is a regression if its median time grew by more than a factor of
+// `1 + R` (default 0.05) and a one-sided Mann-Whitney U test on the samples
+// says the candidate is slower with significance level `P` (default 0.01).
+
+#include <spaces/config.hpp>
+#include <spaces/benchmark.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Just enough of a JSON parser to read our own output. Objects, arrays,
+// strings, numbers, `true`, `false` and `null` are supported.
+struct json_value
+{
+  enum class kind { null, boolean, number, string, array, object };
+
+  kind type = kind::null;
+  double number = 0.0;
+  std::string string;
+  std::vector<json_value> array;
+  std::vector<std::pair<std::string, json_value>> object;
+
+  json_value const* find(std::string_view key) const
+  {
+    for (auto const& [k, v] : object)
+      if (k == key) return &v;
+    return nullptr;
+  }
+};
+
+struct json_parser
+{
+  std::string_view text;
+  std::size_t pos = 0;
+  bool failed = false;
+
+  void skip_whitespace()
+  {
+    while (pos < text.size() && std::isspace((unsigned char)text[pos])) ++pos;
+  }
+
+  bool consume(char c)
+  {
+    skip_whitespace();
+    if (pos < text.size() && text[pos] == c) { ++pos; return true; }
+    return false;
+  }
+
+  bool consume(std::string_view word)
+  {
+    skip_whitespace();
+    if (text.substr(pos, word.size()) == word) {
+      pos += word.size();
+      return true;
+    }
+    return false;
+  }
+
+  std::string parse_string()
+  {
+    std::string s;
+    if (!consume('"')) { failed = true; return s; }
+    while (pos < text.size() && text[pos] != '"') {
+      char c = text[pos++];
+      if (c == '\\' && pos < text.size()) {
+        c = text[pos++];
+        if      (c == 'n') c = '\n';
+        else if (c == 't') c = '\t';
+      }
+      s += c;
+    }
+    if (!consume('"')) failed = true;
+    return s;
+  }
+
+  json_value parse()
+  {
+    json_value v;
+    skip_whitespace();
+
+    if (pos >= text.size()) {
+      failed = true;
+    } else if (text[pos] == '{') {
+      v.type = json_value::kind::object;
+      consume('{');
+      if (!consume('}')) {
+        do {
+          auto key = parse_string();
+          if (!consume(':')) { failed = true; break; }
+          v.object.emplace_back(std::move(key), parse());
+        } while (!failed && consume(','));
+        if (!consume('}')) failed = true;
+      }
+    } else if (text[pos] == '[') {
+      v.type = json_value::kind::array;
+      consume('[');
+      if (!consume(']')) {
+        do v.array.push_back(parse()); while (!failed && consume(','));
+        if (!consume(']')) failed = true;
+      }
+    } else if (text[pos] == '"') {
+      v.type = json_value::kind::string;
+      v.string = parse_string();
+    } else if (consume("true")) {
+      v.type = json_value::kind::boolean;
+      v.number = 1.0;
+    } else if (consume("false")) {
+      v.type = json_value::kind::boolean;
+    } else if (consume("null")) {
+      v.type = json_value::kind::null;
+    } else {
+      char const* first = text.data() + pos;
+      char* last = nullptr;
+      v.type = json_value::kind::number;
+      v.number = std::strtod(first, &last);
+      if (last == first) failed = true;
+      pos += last - first;
+    }
+
+    return v;
+  }
+};
+
+struct benchmark_file
+{
+  std::string compiler;
+  std::string flags;
+
+  // Keyed by "suite/kernel/extents".
+  std::map<std::string, spaces::benchmark_result> results;
+};
+
+bool read_benchmark_file(char const* path, benchmark_file& file)
+{
+  std::ifstream is(path);
+  std::string text(std::istreambuf_iterator<char>(is), {});
+  if (!is && !is.eof()) {
+    std::cerr << "error: could not read '" << path << "'\n";
+    return false;
+  }
+
+  json_parser parser{text};
+  json_value root = parser.parse();
+  if (parser.failed || root.type != json_value::kind::object) {
+    std::cerr << "error: '" << path << "' is not valid benchmark JSON\n";
+    return false;
+  }
+
+  auto string_of = [] (json_value const* v) {
+    return v ? v->string : std::string();
+  };
+
+  file.compiler = string_of(root.find("compiler"));
+  file.flags = string_of(root.find("flags"));
+  auto const suite = string_of(root.find("suite"));
+
+  auto const* benchmarks = root.find("benchmarks");
+  if (!benchmarks) return true;
+
+  for (auto const& b : benchmarks->array) {
+    spaces::benchmark_result r;
+    r.kernel = string_of(b.find("kernel"));
+
+    std::string extents_key;
+    if (auto const* extents = b.find("extents"))
+      for (auto const& e : extents->array) {
+        if (!r.extents.empty()) extents_key += 'x';
+        r.extents.push_back(spaces::index_type(e.number));
+        extents_key += std::to_string(r.extents.back());
+      }
+    std::string key = suite + "/" + r.kernel + "/" + extents_key;
+
+    if (auto const* bytes = b.find("bytes"))
+      r.bytes = std::uint64_t(bytes->number);
+
+    if (auto const* samples = b.find("samples"))
+      for (auto const& s : samples->array) r.samples.push_back(s.number);
+
+    r.time = spaces::compute_statistics(r.samples);
+    file.results.emplace(std::move(key), std::move(r));
+  }
+
+  return true;
+}
+
+// `mann_whitney_slower(baseline, candidate)` - Returns the p-value of a
+// one-sided Mann-Whitney U test of the hypothesis that `candidate` samples
+// tend to be larger than `baseline` samples, using the normal approximation
+// with tie correction.
+double mann_whitney_slower(
+  std::vector<double> const& baseline
+, std::vector<double> const& candidate
+  )
+{
+  double const n0 = baseline.size();
+  double const n1 = candidate.size();
+  if (n0 == 0 || n1 == 0) return 1.0;
+
+  std::vector<std::pair<double, int>> all;
+  for (double x : baseline)  all.emplace_back(x, 0);
+  for (double x : candidate) all.emplace_back(x, 1);
+  std::sort(all.begin(), all.end());
+
+  // Sum of the ranks of the candidate samples, averaging ranks over ties.
+  double rank_sum = 0.0;
+  double tie_term = 0.0;
+  for (std::size_t i = 0; i != all.size();) {
+    std::size_t j = i;
+    while (j != all.size() && all[j].first == all[i].first) ++j;
+    double const t = j - i;
+    double const rank = (i + 1 + j) / 2.0;
+    for (std::size_t k = i; k != j; ++k)
+      if (all[k].second == 1) rank_sum += rank;
+    tie_term += t * t * t - t;
+    i = j;
+  }
+
+  double const n = n0 + n1;
+  double const u = rank_sum - n1 * (n1 + 1) / 2.0;
+  double const mean = n0 * n1 / 2.0;
+  double const variance
+    = n0 * n1 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)));
+  if (variance <= 0.0) return 1.0;
+
+  double const z = (u - mean - 0.5) / std::sqrt(variance);
+  return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+int main(int argc, char** argv)
+{
+  double threshold = 0.05;
+  double alpha = 0.01;
+  std::vector<char const*> paths;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg.starts_with("--threshold="))
+      threshold = std::strtod(argv[i] + 12, nullptr);
+    else if (arg.starts_with("--alpha="))
+      alpha = std::strtod(argv[i] + 8, nullptr);
+    else
+      paths.push_back(argv[i]);
+  }
+
+  if (paths.size() != 2) {
+    std::cerr << "usage: " << argv[0]
+              << " [--threshold=R] [--alpha=P] BASELINE CANDIDATE\n";
+    return 2;
+  }
+
+  benchmark_file baseline, candidate;
+  if (!read_benchmark_file(paths[0], baseline)
+   || !read_benchmark_file(paths[1], candidate))
+    return 2;
+
+  if (baseline.compiler != candidate.compiler)
+    std::cout << "note: compilers differ: '" << baseline.compiler
+              << "' vs '" << candidate.compiler << "'\n";
+  if (baseline.flags != candidate.flags)
+    std::cout << "note: flags differ: '" << baseline.flags
+              << "' vs '" << candidate.flags << "'\n";
+
+  std::size_t width = std::strlen("benchmark");
+  for (auto const& [key, r] : candidate.results)
+    width = std::max(width, key.size());
+
+  std::cout << std::left  << std::setw(width) << "benchmark"
+            << std::right << std::setw(16) << "baseline [us]"
+                          << std::setw(16) << "candidate [us]"
+                          << std::setw(10) << "ratio"
+                          << std::setw(12) << "p-value"
+                          << "  verdict\n"
+            << std::fixed;
+
+  int regressions = 0;
+
+  for (auto const& [key, c] : candidate.results) {
+    auto it = baseline.results.find(key);
+    if (it == baseline.results.end()) {
+      std::cout << std::left << std::setw(width) << key
+                << std::right << std::setw(16) << "-"
+                << std::setprecision(3)
+                << std::setw(16) << c.time.median * 1.0e6
+                << std::setw(10) << "-" << std::setw(12) << "-"
+                << "  new\n";
+      continue;
+    }
+    auto const& b = it->second;
+
+    double const ratio = c.time.median / b.time.median;
+    double const p = mann_whitney_slower(b.samples, c.samples);
+    bool const regressed = ratio > 1.0 + threshold && p < alpha;
+    bool const improved = ratio < 1.0 - threshold
+                       && mann_whitney_slower(c.samples, b.samples) < alpha;
+    regressions += regressed;
+
+    std::cout << std::left << std::setw(width) << key
+              << std::right << std::setprecision(3)
+              << std::setw(16) << b.time.median * 1.0e6
+              << std::setw(16) << c.time.median * 1.0e6
+              << std::setw(9) << ratio << "x"
+              << std::setprecision(4) << std::setw(12) << p
+              << "  " << (regressed ? "REGRESSION"
+                        : improved  ? "improvement"
+                                    : "unchanged")
+              << "\n";
+  }
+
+  for (auto const& [key, b] : baseline.results)
+    if (!candidate.results.contains(key))
+      std::cout << std::left << std::setw(width) << key << "  removed\n";
+
+  if (regressions) {
+    std::cout << regressions << " regression" << (regressions == 1 ? "" : "s")
+              << " detected.\n";
+    return 1;
+  }
+
+  return 0;
+}
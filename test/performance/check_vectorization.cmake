@@ -0,0 +1,54 @@
+# Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+# Copyright (c) 2017-2023 NVIDIA Corporation
+#
+# Distributed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+# Checks that the optimization report of a kernel shows at least EXPECTED
+# vectorized loops. Usage:
+#
+#   cmake -DKERNEL=<name> -DEXPECTED=<count> -DREPORT=<file>
+#         -DREFERENCE_REPORT=<file> -P check_vectorization.cmake
+#
+# Understands Clang's `-Rpass=loop-vectorize` remarks and GCC's
+# `-fopt-info-vec` output. If the kernel isn't a reference kernel and the
+# reference kernel's report shows no vectorized loops, the check is skipped:
+# a spaces abstraction is only at fault when it loses vectorization that the
+# hand-written loop retains.
+
+set(SPACES_VECTORIZED_REGEX "(remark: vectorized loop|optimized: loop vectorized)")
+
+function(spaces_count_vectorized_loops REPORT_FILE OUT)
+  if(NOT EXISTS ${REPORT_FILE})
+    message(FATAL_ERROR "${REPORT_FILE} does not exist; build the "
+                        "*_optimization_report targets first.")
+  endif()
+  file(STRINGS ${REPORT_FILE} LINES REGEX "${SPACES_VECTORIZED_REGEX}")
+  list(LENGTH LINES COUNT)
+  set(${OUT} ${COUNT} PARENT_SCOPE)
+endfunction()
+
+spaces_count_vectorized_loops(${REPORT} SPACES_ACTUAL)
+
+if(SPACES_ACTUAL GREATER_EQUAL EXPECTED)
+  message(STATUS "${KERNEL}: ${SPACES_ACTUAL} vectorized loop(s), "
+                 "expected at least ${EXPECTED}.")
+  return()
+endif()
+
+if(NOT REPORT STREQUAL REFERENCE_REPORT)
+  spaces_count_vectorized_loops(${REFERENCE_REPORT} SPACES_REFERENCE)
+  if(SPACES_REFERENCE EQUAL 0)
+    message(STATUS "SKIPPED: ${KERNEL}: the reference kernel doesn't "
+                   "vectorize either.")
+    return()
+  endif()
+endif()
+
+file(STRINGS ${REPORT} SPACES_LINES
+  REGEX "(remark: loop not vectorized|missed: (couldn't vectorize|not vectorized))")
+list(JOIN SPACES_LINES "\n" SPACES_LINES)
+message(FATAL_ERROR "${KERNEL}: ${SPACES_ACTUAL} vectorized loop(s), expected "
+                    "at least ${EXPECTED}. Missed optimizations:\n"
+                    "${SPACES_LINES}")
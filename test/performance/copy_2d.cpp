@@ -0,0 +1,136 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/huge_page_allocator.hpp>
+#include <spaces/test.hpp>
+#include <spaces/benchmark.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <memory>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+using input_2d
+  = spaces::mdspan<double const, spaces::dextents<2>, spaces::layout_left>;
+using output_2d
+  = spaces::mdspan<double, spaces::dextents<2>, spaces::layout_right>;
+
+extern void copy_2d_reference(
+  double const* __restrict__ A
+, double* __restrict__ B
+, spaces::index_type N
+, spaces::index_type M
+  ) noexcept;
+
+extern void copy_2d_space_based_for_each(input_2d A, output_2d B);
+
+extern void copy_2d_copy(input_2d A, output_2d B);
+
+extern void copy_2d_copy_par_unseq(input_2d A, output_2d B);
+
+void set_to_initial_state(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+, output_2d B
+) {
+  for (spaces::index_type j = 0; j != A.extent(1); ++j)
+    for (spaces::index_type i = 0; i != A.extent(0); ++i) {
+      A(i, j) = A.mapping()(i, j);
+      B(i, j) = -1.0;
+    }
+}
+
+void validate_state(input_2d A, output_2d B) {
+  for (spaces::index_type j = 0; j != A.extent(1); ++j)
+    for (spaces::index_type i = 0; i != A.extent(0); ++i)
+      SPACES_TEST_EQ(B(i, j), A.mapping()(i, j));
+}
+
+using copy_2d_kernel = void (*)(input_2d, output_2d);
+
+struct named_copy_2d_kernel
+{
+  char const* name;
+  copy_2d_kernel kernel;
+};
+
+named_copy_2d_kernel const kernels[] = {
+  {"copy_2d_reference",
+    [] (input_2d A, output_2d B)
+    {
+      copy_2d_reference(
+        A.data_handle(), B.data_handle(), A.extent(0), A.extent(1)
+      );
+    }}
+, {"copy_2d_space_based_for_each",
+    copy_2d_space_based_for_each}
+, {"copy_2d_copy",
+    copy_2d_copy}
+, {"copy_2d_copy_par_unseq",
+    copy_2d_copy_par_unseq}
+};
+
+// `--sizes=N,...` runs the kernels on N x N arrays. N must be a multiple of
+// 32, as the reference kernel assumes. `--sweep` picks such N so that the
+// footprints double from the L1 cache to main memory. Every kernel copies a
+// column major array to a row major one.
+int main(int argc, char** argv) {
+  auto const options = spaces::parse_benchmark_options(argc, argv);
+
+#if defined(SPACES_BENCHMARK)
+  std::vector<spaces::benchmark_result> results;
+#endif
+
+  for (spaces::index_type N :
+       options.extents_for(2, 2 * sizeof(double), 32, 128)) {
+    if (N % 32 != 0) {
+      std::cerr << "error: size " << N << " is not a multiple of 32\n";
+      return 1;
+    }
+    spaces::index_type const M = N;
+
+    auto a = spaces::make_huge_page_mdarray<double>(
+      spaces::layout_left::mapping{spaces::extents{N, M}}
+    );
+    auto b = spaces::make_huge_page_mdarray<double>(
+      spaces::layout_right::mapping{spaces::extents{N, M}}
+    );
+
+    spaces::mdspan A = a.to_mdspan();
+    spaces::mdspan B = b.to_mdspan();
+
+    for (auto [name, kernel] : kernels) {
+      set_to_initial_state(A, B);
+      kernel(A, B);
+      validate_state(A, B);
+    }
+
+#if defined(SPACES_BENCHMARK)
+    spaces::benchmark_kernels(
+      results, kernels, {A.extent(0), A.extent(1)}
+    , 2 * A.extent(0) * A.extent(1) * sizeof(double)
+    , [&] { set_to_initial_state(A, B); }
+    , [&] (auto kernel) { kernel(A, B); }
+    , options
+    );
+#endif
+  }
+
+#if defined(SPACES_BENCHMARK)
+  if (!spaces::report_benchmarks(
+        "copy_2d", "copy_2d_reference", results, options
+      ))
+    return 1;
+#endif
+
+  return spaces::test_report_errors();
+}
@@ -0,0 +1,18 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/copy.hpp>
+
+void copy_2d_copy(
+  spaces::mdspan<double const, spaces::dextents<2>, spaces::layout_left> A
+, spaces::mdspan<double, spaces::dextents<2>, spaces::layout_right> B
+  ) noexcept
+{
+  spaces::copy(A, B);
+}
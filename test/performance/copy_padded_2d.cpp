@@ -0,0 +1,183 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/huge_page_allocator.hpp>
+#include <spaces/padded_layout.hpp>
+#include <spaces/mapped_file.hpp>
+#include <spaces/save.hpp>
+#include <spaces/test.hpp>
+#include <spaces/benchmark.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using input_2d = spaces::mdspan<
+  double const, spaces::dextents<2>, spaces::layout_left_padded<>
+>;
+using output_2d
+  = spaces::mdspan<double, spaces::dextents<2>, spaces::layout_right_padded<>>;
+
+extern void copy_padded_2d_reference(
+  double const* __restrict__ A
+, double* __restrict__ B
+, spaces::index_type N
+, spaces::index_type M
+, spaces::index_type SA
+, spaces::index_type SB
+  ) noexcept;
+
+extern void copy_padded_2d_space_based_for_each(input_2d A, output_2d B);
+
+extern void copy_padded_2d_copy(input_2d A, output_2d B);
+
+// The padding of `B` is set to a value that no kernel writes, so that
+// `validate_state` can check that it was never visited.
+constexpr double padding_value = -2.0;
+
+void set_to_initial_state(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left_padded<>> A
+, output_2d B
+) {
+  std::fill_n(B.data_handle(), B.mapping().required_span_size(), padding_value);
+  for (spaces::index_type j = 0; j != A.extent(1); ++j)
+    for (spaces::index_type i = 0; i != A.extent(0); ++i) {
+      A(i, j) = A.mapping()(i, j);
+      B(i, j) = -1.0;
+    }
+}
+
+void validate_state(input_2d A, output_2d B) {
+  for (spaces::index_type j = 0; j != A.extent(1); ++j)
+    for (spaces::index_type i = 0; i != A.extent(0); ++i)
+      SPACES_TEST_EQ(B(i, j), A.mapping()(i, j));
+  for (spaces::index_type i = 0; i != B.extent(0); ++i)
+    for (spaces::index_type j = B.extent(1); j != B.stride(0); ++j)
+      SPACES_TEST_EQ(B.data_handle()[j + i * B.stride(0)], padding_value);
+}
+
+using copy_padded_2d_kernel = void (*)(input_2d, output_2d);
+
+struct named_copy_padded_2d_kernel
+{
+  char const* name;
+  copy_padded_2d_kernel kernel;
+};
+
+named_copy_padded_2d_kernel const kernels[] = {
+  {"copy_padded_2d_reference",
+    [] (input_2d A, output_2d B)
+    {
+      copy_padded_2d_reference(
+        A.data_handle(), B.data_handle(), A.extent(0), A.extent(1)
+      , A.stride(1), B.stride(0)
+      );
+    }}
+, {"copy_padded_2d_space_based_for_each",
+    copy_padded_2d_space_based_for_each}
+, {"copy_padded_2d_copy",
+    copy_padded_2d_copy}
+};
+
+// `--sizes=N,...` runs the kernels on N x N arrays. N must be a multiple of
+// 32, as the reference kernel assumes. `--sweep` picks such N so that the
+// footprints double from the L1 cache to main memory. Every kernel copies a
+// column major array to a row major one, like copy_2d, but both are padded by
+// `aliasing_free_padding`, so their columns and rows don't alias in the
+// cache.
+int main(int argc, char** argv) {
+  auto const options = spaces::parse_benchmark_options(argc, argv);
+
+#if defined(SPACES_BENCHMARK)
+  std::vector<spaces::benchmark_result> results;
+#endif
+
+  for (spaces::index_type N :
+       options.extents_for(2, 2 * sizeof(double), 32, 128)) {
+    if (N % 32 != 0) {
+      std::cerr << "error: size " << N << " is not a multiple of 32\n";
+      return 1;
+    }
+    spaces::index_type const M = N;
+
+    spaces::layout_left_padded<>::mapping<spaces::dextents<2>> const a_map(
+      spaces::dextents<2>{N, M}, spaces::aliasing_free_padding<double>(N)
+    );
+    spaces::layout_right_padded<>::mapping<spaces::dextents<2>> const b_map(
+      spaces::dextents<2>{N, M}, spaces::aliasing_free_padding<double>(M)
+    );
+
+    auto a = spaces::make_huge_page_mdarray<double>(a_map);
+    auto b = spaces::make_huge_page_mdarray<double>(b_map);
+
+    spaces::mdspan A = a.to_mdspan();
+    spaces::mdspan B = b.to_mdspan();
+
+    for (auto [name, kernel] : kernels) {
+      set_to_initial_state(A, B);
+      kernel(A, B);
+      validate_state(A, B);
+    }
+
+    // `B` saved with its padding maps back as a `layout_stride` array with
+    // the same strides, but not as a `layout_right_padded<>` one, which can't
+    // be built with that padding from the extents alone.
+    {
+      auto const path = std::filesystem::temp_directory_path()
+        / ("spaces_copy_padded_2d_" + std::to_string(::getpid()));
+      SPACES_TEST(spaces::save(path.c_str(), B));
+      auto s = spaces::load<double, spaces::dextents<2>, spaces::layout_stride>(
+        path.c_str()
+      );
+      auto p = spaces::load<
+        double, spaces::dextents<2>, spaces::layout_right_padded<>
+      >(path.c_str());
+      std::filesystem::remove(path);
+      SPACES_TEST(s.has_value());
+      bool const unpadded = B.stride(0) == B.extent(1);
+      SPACES_TEST_EQ(p.has_value(), unpadded);
+      if (s) {
+        auto S = s->to_mdspan();
+        SPACES_TEST_EQ(S.stride(0), B.stride(0));
+        SPACES_TEST_EQ(S.stride(1), B.stride(1));
+        for (spaces::index_type i = 0; i != B.extent(0); ++i)
+          for (spaces::index_type j = 0; j != B.extent(1); ++j)
+            SPACES_TEST_EQ(S(i, j), B(i, j));
+      }
+    }
+
+#if defined(SPACES_BENCHMARK)
+    spaces::benchmark_kernels(
+      results, kernels, {A.extent(0), A.extent(1)}
+    , 2 * A.extent(0) * A.extent(1) * sizeof(double)
+    , [&] { set_to_initial_state(A, B); }
+    , [&] (auto kernel) { kernel(A, B); }
+    , options
+    );
+#endif
+  }
+
+#if defined(SPACES_BENCHMARK)
+  if (!spaces::report_benchmarks(
+        "copy_padded_2d", "copy_padded_2d_reference", results, options
+      ))
+    return 1;
+#endif
+
+  return spaces::test_report_errors();
+}
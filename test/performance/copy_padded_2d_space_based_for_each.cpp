@@ -0,0 +1,25 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/padded_layout.hpp>
+#include <spaces/cursor.hpp>
+#include <spaces/for_each.hpp>
+
+void copy_padded_2d_space_based_for_each(
+  spaces::mdspan<
+    double const, spaces::dextents<2>, spaces::layout_left_padded<>
+  > A
+, spaces::mdspan<double, spaces::dextents<2>, spaces::layout_right_padded<>> B
+  ) noexcept
+{
+  spaces::for_each(
+    spaces::cursor(A.extents())
+  , [=] (auto i, auto j) { B(i, j) = A(i, j); }
+  );
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/huge_page_allocator.hpp>
+#include <spaces/test.hpp>
+#include <spaces/benchmark.hpp>
+
+#include <array>
+#include <iostream>
+#include <vector>
+
+using input_3d
+  = spaces::mdspan<float const, spaces::dextents<3>, spaces::layout_left>;
+using output_3d
+  = spaces::mdspan<float, spaces::dextents<3>, spaces::layout_stride>;
+
+extern void copy_permuted_3d_reference(
+  float const* __restrict__ A
+, float* __restrict__ B
+, spaces::index_type N
+, spaces::index_type M
+, spaces::index_type O
+  ) noexcept;
+
+extern void copy_permuted_3d_copy(input_3d A, output_3d B);
+
+void set_to_initial_state(
+  spaces::mdspan<float, spaces::dextents<3>, spaces::layout_left> A
+, output_3d B
+) {
+  for (spaces::index_type k = 0; k != A.extent(2); ++k)
+    for (spaces::index_type j = 0; j != A.extent(1); ++j)
+      for (spaces::index_type i = 0; i != A.extent(0); ++i) {
+        A(i, j, k) = float(A.mapping()(i, j, k));
+        B(i, j, k) = -1.0f;
+      }
+}
+
+void validate_state(input_3d A, output_3d B) {
+  for (spaces::index_type k = 0; k != A.extent(2); ++k)
+    for (spaces::index_type j = 0; j != A.extent(1); ++j)
+      for (spaces::index_type i = 0; i != A.extent(0); ++i)
+        SPACES_TEST_EQ(B(i, j, k), float(A.mapping()(i, j, k)));
+}
+
+using copy_permuted_3d_kernel = void (*)(input_3d, output_3d);
+
+struct named_copy_permuted_3d_kernel
+{
+  char const* name;
+  copy_permuted_3d_kernel kernel;
+};
+
+named_copy_permuted_3d_kernel const kernels[] = {
+  {"copy_permuted_3d_reference",
+    [] (input_3d A, output_3d B)
+    {
+      copy_permuted_3d_reference(
+        A.data_handle(), B.data_handle()
+      , A.extent(0), A.extent(1), A.extent(2)
+      );
+    }}
+, {"copy_permuted_3d_copy",
+    copy_permuted_3d_copy}
+};
+
+// `--sizes=N,...` runs the kernels on N x N x N arrays. N must be a multiple of
+// 32, as the reference kernel assumes. `--sweep` picks such N so that the
+// footprints double from the L1 cache to main memory. Every kernel copies a
+// column major array of `float`s to a `layout_stride` one that's contiguous
+// along its second axis, then its third, then its first, which permutes the
+// axes in a way that neither `layout_left` nor `layout_right` can.
+int main(int argc, char** argv) {
+  auto const options = spaces::parse_benchmark_options(argc, argv);
+
+#if defined(SPACES_BENCHMARK)
+  std::vector<spaces::benchmark_result> results;
+#endif
+
+  for (spaces::index_type N :
+       options.extents_for(3, 2 * sizeof(float), 32, 64)) {
+    if (N % 32 != 0) {
+      std::cerr << "error: size " << N << " is not a multiple of 32\n";
+      return 1;
+    }
+    spaces::index_type const M = N;
+    spaces::index_type const O = N;
+
+    auto a = spaces::make_huge_page_mdarray<float>(
+      spaces::layout_left::mapping{spaces::extents{N, M, O}}
+    );
+    auto b = spaces::make_huge_page_mdarray<float>(
+      spaces::layout_stride::mapping{
+        spaces::dextents<3>{N, M, O}
+      , std::array<spaces::index_type, 3>{M * O, 1, M}
+      }
+    );
+
+    spaces::mdspan A = a.to_mdspan();
+    output_3d B = b.to_mdspan();
+
+    for (auto [name, kernel] : kernels) {
+      set_to_initial_state(A, B);
+      kernel(A, B);
+      validate_state(A, B);
+    }
+
+#if defined(SPACES_BENCHMARK)
+    spaces::benchmark_kernels(
+      results, kernels, {A.extent(0), A.extent(1), A.extent(2)}
+    , 2 * A.extent(0) * A.extent(1) * A.extent(2) * sizeof(float)
+    , [&] { set_to_initial_state(A, B); }
+    , [&] (auto kernel) { kernel(A, B); }
+    , options
+    );
+#endif
+  }
+
+#if defined(SPACES_BENCHMARK)
+  if (!spaces::report_benchmarks(
+        "copy_permuted_3d", "copy_permuted_3d_reference", results, options
+      ))
+    return 1;
+#endif
+
+  return spaces::test_report_errors();
+}
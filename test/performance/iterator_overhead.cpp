@@ -0,0 +1,137 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Measures the fixed cost that each way of iterating over a 2D index space
+// adds to every element. Each kernel visits every index `(i, j)` of an N x M
+// space with a trivial body (summing `i + j * N`) that the compiler must not
+// fold away or vectorize, so the time per element is dominated by the
+// iteration itself. Run the benchmark with `--counters` to see cycles and
+// instructions per element.
+
+#include <spaces/config.hpp>
+#include <spaces/test.hpp>
+#include <spaces/benchmark.hpp>
+
+#include <iostream>
+#include <vector>
+
+extern spaces::index_type iterator_overhead_reference(
+  spaces::index_type N
+, spaces::index_type M
+  ) noexcept;
+
+extern spaces::index_type iterator_overhead_cursor_range(
+  spaces::index_type N
+, spaces::index_type M
+  ) noexcept;
+
+extern spaces::index_type iterator_overhead_cursor_for_each(
+  spaces::index_type N
+, spaces::index_type M
+  ) noexcept;
+
+extern spaces::index_type iterator_overhead_index_forward_iterators(
+  spaces::index_type N
+, spaces::index_type M
+  ) noexcept;
+
+extern spaces::index_type iterator_overhead_index_known_distance_iterators(
+  spaces::index_type N
+, spaces::index_type M
+  ) noexcept;
+
+extern spaces::index_type iterator_overhead_storage_range_based_for_loop(
+  spaces::index_type N
+, spaces::index_type M
+  ) noexcept;
+
+extern spaces::index_type iterator_overhead_cartesian_product_iota(
+  spaces::index_type N
+, spaces::index_type M
+  ) noexcept;
+
+extern spaces::index_type iterator_overhead_index_generator(
+  spaces::index_type N
+, spaces::index_type M
+  );
+
+extern spaces::index_type iterator_overhead_index_generator_batched(
+  spaces::index_type N
+, spaces::index_type M
+  );
+
+using iterator_overhead_kernel =
+  spaces::index_type (*)(spaces::index_type, spaces::index_type);
+
+struct named_iterator_overhead_kernel
+{
+  char const* name;
+  iterator_overhead_kernel kernel;
+};
+
+named_iterator_overhead_kernel const kernels[] = {
+  {"iterator_overhead_reference",
+    iterator_overhead_reference}
+, {"iterator_overhead_cursor_range",
+    iterator_overhead_cursor_range}
+, {"iterator_overhead_cursor_for_each",
+    iterator_overhead_cursor_for_each}
+, {"iterator_overhead_index_forward_iterators",
+    iterator_overhead_index_forward_iterators}
+, {"iterator_overhead_index_known_distance_iterators",
+    iterator_overhead_index_known_distance_iterators}
+, {"iterator_overhead_storage_range_based_for_loop",
+    iterator_overhead_storage_range_based_for_loop}
+, {"iterator_overhead_cartesian_product_iota",
+    iterator_overhead_cartesian_product_iota}
+, {"iterator_overhead_index_generator",
+    iterator_overhead_index_generator}
+, {"iterator_overhead_index_generator_batched",
+    iterator_overhead_index_generator_batched}
+};
+
+// `--sizes=N,...` runs the kernels on N x N index spaces.
+int main(int argc, char** argv) {
+  auto const options = spaces::parse_benchmark_options(argc, argv);
+
+#if defined(SPACES_BENCHMARK)
+  std::vector<spaces::benchmark_result> results;
+#endif
+
+  for (spaces::index_type N :
+       options.extents_for(2, sizeof(spaces::index_type), 1, 256)) {
+    spaces::index_type const M = N;
+
+    // Every index is visited exactly once, so the sum is that of the offsets
+    // `0, ..., N * M - 1`.
+    spaces::index_type const expected = N * M * (N * M - 1) / 2;
+
+    for (auto [name, kernel] : kernels)
+      SPACES_TEST_EQ(kernel(N, M), expected);
+
+#if defined(SPACES_BENCHMARK)
+    spaces::benchmark_kernels(
+      results, kernels, {N, M}, 0
+    , [] {}
+    , [&] (auto kernel) { kernel(N, M); }
+    , options
+    );
+#endif
+  }
+
+#if defined(SPACES_BENCHMARK)
+  bool const success = spaces::report_benchmarks(
+    "iterator_overhead", "iterator_overhead_reference", results, options
+  );
+  std::cout << "\n";
+  spaces::benchmark_report_per_element(std::cout, results);
+  if (!success)
+    return 1;
+#endif
+
+  return spaces::test_report_errors();
+}
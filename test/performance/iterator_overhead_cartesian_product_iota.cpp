@@ -0,0 +1,31 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/cartesian_product.hpp>
+
+#include <ranges>
+
+spaces::index_type iterator_overhead_cartesian_product_iota(
+  spaces::index_type N
+, spaces::index_type M
+  ) noexcept
+{
+  auto indices =
+    spaces::cartesian_product(
+      std::views::iota(0LU, N)
+    , std::views::iota(0LU, M)
+    );
+
+  spaces::index_type sum = 0;
+  for (auto [i, j] : indices) {
+    sum += i + j * N;
+    SPACES_DO_NOT_OPTIMIZE(sum);
+  }
+  return sum;
+}
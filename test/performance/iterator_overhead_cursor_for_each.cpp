@@ -0,0 +1,27 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/cursor.hpp>
+#include <spaces/for_each.hpp>
+
+spaces::index_type iterator_overhead_cursor_for_each(
+  spaces::index_type N
+, spaces::index_type M
+  ) noexcept
+{
+  spaces::index_type sum = 0;
+  spaces::for_each(
+    spaces::cursor<2>(N, M)
+  , [&] (auto i, auto j) {
+      sum += i + j * N;
+      SPACES_DO_NOT_OPTIMIZE(sum);
+    }
+  );
+  return sum;
+}
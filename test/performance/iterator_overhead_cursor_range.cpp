@@ -0,0 +1,28 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/cursor.hpp>
+
+#include <tuple>
+
+spaces::index_type iterator_overhead_cursor_range(
+  spaces::index_type N
+, spaces::index_type M
+  ) noexcept
+{
+  spaces::cursor<2> c(N, M);
+
+  spaces::index_type sum = 0;
+  for (auto outer : mdrange<1>(c, std::tuple<>{}))
+    for (auto [i, j] : mdrange<0>(c, outer)) {
+      sum += i + j * N;
+      SPACES_DO_NOT_OPTIMIZE(sum);
+    }
+  return sum;
+}
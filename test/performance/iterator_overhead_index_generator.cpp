@@ -0,0 +1,23 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/index_generator.hpp>
+
+spaces::index_type iterator_overhead_index_generator(
+  spaces::index_type N
+, spaces::index_type M
+  )
+{
+  spaces::index_type sum = 0;
+  for (auto pos : spaces::generate_indices(N, M)) {
+    sum += pos[0] + pos[1] * N;
+    SPACES_DO_NOT_OPTIMIZE(sum);
+  }
+  return sum;
+}
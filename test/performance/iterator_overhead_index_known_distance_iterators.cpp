@@ -0,0 +1,29 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/index_md_range.hpp>
+
+spaces::index_type iterator_overhead_index_known_distance_iterators(
+  spaces::index_type N
+, spaces::index_type M
+  ) noexcept
+{
+  auto&& r   = spaces::index_2d_range(N, M);
+  auto first = r.begin();
+
+  spaces::index_type sum = 0;
+  spaces::index_type const dist = N * M;
+  for (spaces::index_type d = 0; d < dist; ++d, ++first)
+  {
+    auto pos = *first;
+    sum += pos[0] + pos[1] * N;
+    SPACES_DO_NOT_OPTIMIZE(sum);
+  }
+  return sum;
+}
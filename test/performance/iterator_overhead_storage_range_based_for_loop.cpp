@@ -0,0 +1,23 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/storage_md_range.hpp>
+
+spaces::index_type iterator_overhead_storage_range_based_for_loop(
+  spaces::index_type N
+, spaces::index_type M
+  ) noexcept
+{
+  spaces::index_type sum = 0;
+  for (auto pos : spaces::storage_2d_range(N, M)) {
+    sum += pos[0] + pos[1] * N;
+    SPACES_DO_NOT_OPTIMIZE(sum);
+  }
+  return sum;
+}
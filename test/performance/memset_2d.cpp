@@ -8,12 +8,16 @@
 #include <spaces/config.hpp>
 #include <spaces/optimization_hints.hpp>
 #include <spaces/mdspan.hpp>
+#include <spaces/huge_page_allocator.hpp>
 #include <spaces/test.hpp>
+#include <spaces/benchmark.hpp>
 
 #include <cassert>
 #include <cstdlib>
 #include <memory>
 #include <functional>
+#include <iostream>
+#include <vector>
 
 extern void memset_2d_reference(
   double* __restrict__ A
@@ -45,22 +49,62 @@ extern void memset_2d_index_known_distance_iterators(
   spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
   ) noexcept;
 
+extern void memset_2d_index_par_unseq(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  );
+
 extern void memset_2d_storage_range_based_for_loop(
   spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
   ) noexcept;
 
+extern void memset_2d_storage_random_access_iterators(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  ) noexcept;
+
 extern void memset_2d_cartesian_product_iota(
   spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
   ) noexcept;
 
+extern void memset_2d_cartesian_product_iota_for_each(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  ) noexcept;
+
+extern void memset_2d_cartesian_product_par_unseq(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  );
+
+extern void memset_2d_cartesian_product_forward_par_unseq(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  );
+
+extern void memset_2d_cursor_flatten_par_unseq(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  );
+
 extern void memset_2d_index_generator(
   spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
   );
 
+extern void memset_2d_index_generator_arena(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  );
+
+extern void memset_2d_index_generator_batched(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  );
+
 extern void memset_2d_space_based_for_each(
   spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
   );
 
+extern void memset_2d_space_based_for_each_reverse(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  );
+
+extern void memset_2d_space_based_for_each_aligned(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  );
+
 void set_to_initial_state(
   spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
 ) {
@@ -77,55 +121,105 @@ void validate_state(
       SPACES_TEST_EQ(A(i, j), 0.0);
 }
 
-int main() {
-  constexpr spaces::index_type N = 128;
-  constexpr spaces::index_type M = 128;
-
-  std::unique_ptr<double[]> data(
-    reinterpret_cast<double*>(std::aligned_alloc(32, N * M * sizeof(double)))
-  );
-  spaces::mdspan A(data.get(), spaces::layout_left::mapping{spaces::extents{N, M}});
-
-  set_to_initial_state(A);
-  memset_2d_reference(A.data_handle(), A.extent(0), A.extent(1));
-  validate_state(A);
-
-  set_to_initial_state(A);
-  memset_2d_mdspan_raw_loop(A);
-  validate_state(A);
-
-  set_to_initial_state(A);
-  memset_2d_index_range_based_for_loop(A);
-  validate_state(A);
-
-  set_to_initial_state(A);
-  memset_2d_index_forward_iterators(A);
-  validate_state(A);
-
-  set_to_initial_state(A);
-  memset_2d_index_random_access_iterators(A);
-  validate_state(A);
-
-  set_to_initial_state(A);
-  memset_2d_index_known_distance_iterators(A);
-  validate_state(A);
-
-  set_to_initial_state(A);
-  memset_2d_storage_range_based_for_loop(A);
-  validate_state(A);
-
-  set_to_initial_state(A);
-  memset_2d_cartesian_product_iota(A);
-  validate_state(A);
-
-  set_to_initial_state(A);
-  memset_2d_index_generator(A);
-  validate_state(A);
-
-  set_to_initial_state(A);
-  memset_2d_space_based_for_each(A);
-  validate_state(A);
+using memset_2d_kernel =
+  void (*)(spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left>);
+
+struct named_memset_2d_kernel
+{
+  char const* name;
+  memset_2d_kernel kernel;
+};
+
+named_memset_2d_kernel const kernels[] = {
+  {"memset_2d_reference",
+    [] (spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A)
+    { memset_2d_reference(A.data_handle(), A.extent(0), A.extent(1)); }}
+, {"memset_2d_mdspan_raw_loop",
+    memset_2d_mdspan_raw_loop}
+, {"memset_2d_index_range_based_for_loop",
+    memset_2d_index_range_based_for_loop}
+, {"memset_2d_index_forward_iterators",
+    memset_2d_index_forward_iterators}
+, {"memset_2d_index_random_access_iterators",
+    memset_2d_index_random_access_iterators}
+, {"memset_2d_index_known_distance_iterators",
+    memset_2d_index_known_distance_iterators}
+, {"memset_2d_index_par_unseq",
+    memset_2d_index_par_unseq}
+, {"memset_2d_storage_range_based_for_loop",
+    memset_2d_storage_range_based_for_loop}
+, {"memset_2d_storage_random_access_iterators",
+    memset_2d_storage_random_access_iterators}
+, {"memset_2d_cartesian_product_iota",
+    memset_2d_cartesian_product_iota}
+, {"memset_2d_cartesian_product_iota_for_each",
+    memset_2d_cartesian_product_iota_for_each}
+, {"memset_2d_cartesian_product_par_unseq",
+    memset_2d_cartesian_product_par_unseq}
+, {"memset_2d_cartesian_product_forward_par_unseq",
+    memset_2d_cartesian_product_forward_par_unseq}
+, {"memset_2d_cursor_flatten_par_unseq",
+    memset_2d_cursor_flatten_par_unseq}
+, {"memset_2d_index_generator",
+    memset_2d_index_generator}
+, {"memset_2d_index_generator_arena",
+    memset_2d_index_generator_arena}
+, {"memset_2d_index_generator_batched",
+    memset_2d_index_generator_batched}
+, {"memset_2d_space_based_for_each",
+    memset_2d_space_based_for_each}
+, {"memset_2d_space_based_for_each_reverse",
+    memset_2d_space_based_for_each_reverse}
+, {"memset_2d_space_based_for_each_aligned",
+    memset_2d_space_based_for_each_aligned}
+};
+
+// `--sizes=N,...` runs the kernels on N x N arrays. N must be a multiple of
+// 32, as the reference kernel assumes. `--sweep` picks such N so that the
+// footprints double from the L1 cache to main memory.
+int main(int argc, char** argv) {
+  auto const options = spaces::parse_benchmark_options(argc, argv);
+
+#if defined(SPACES_BENCHMARK)
+  std::vector<spaces::benchmark_result> results;
+#endif
+
+  for (spaces::index_type N :
+       options.extents_for(2, sizeof(double), 32, 128)) {
+    if (N % 32 != 0) {
+      std::cerr << "error: size " << N << " is not a multiple of 32\n";
+      return 1;
+    }
+    spaces::index_type const M = N;
+
+    auto data = spaces::make_huge_page_mdarray<double>(
+      spaces::layout_left::mapping{spaces::extents{N, M}}
+    );
+    spaces::mdspan A = data.to_mdspan();
+
+    for (auto [name, kernel] : kernels) {
+      set_to_initial_state(A);
+      kernel(A);
+      validate_state(A);
+    }
+
+#if defined(SPACES_BENCHMARK)
+    spaces::benchmark_kernels(
+      results, kernels, {A.extent(0), A.extent(1)}
+    , A.size() * sizeof(double)
+    , [&] { set_to_initial_state(A); }
+    , [&] (auto kernel) { kernel(A); }
+    , options
+    );
+#endif
+  }
+
+#if defined(SPACES_BENCHMARK)
+  if (!spaces::report_benchmarks(
+        "memset_2d", "memset_2d_reference", results, options
+      ))
+    return 1;
+#endif
 
   return spaces::test_report_errors();
 }
-
@@ -0,0 +1,44 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/cartesian_product.hpp>
+
+#include <forward_list>
+#include <ranges>
+
+#if defined(SPACES_HAS_PARALLEL_EXECUTION)
+  #include <spaces/parallel_for_each.hpp>
+#endif
+
+// The columns are the elements of a `std::forward_list`, which is only a
+// forward range, so `for_each` makes a task of each column instead of
+// splitting the product into chunks of elements. Without a parallel
+// algorithms backend, the product is iterated sequentially.
+void memset_2d_cartesian_product_forward_par_unseq(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  )
+{
+  std::forward_list<spaces::index_type> columns;
+  for (spaces::index_type j = A.extent(1); j != 0; --j)
+    columns.push_front(j - 1);
+
+  auto const product = spaces::cartesian_product(
+    std::views::all(columns)
+  , std::views::iota(spaces::index_type(0), A.extent(0))
+  );
+
+  #if defined(SPACES_HAS_PARALLEL_EXECUTION)
+    spaces::for_each(
+      std::execution::par_unseq, product
+    , [=] (auto j, auto i) { A(i, j) = 0.0; }
+    );
+  #else
+    for (auto [j, i] : product) A(i, j) = 0.0;
+  #endif
+}
@@ -0,0 +1,26 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/cartesian_product.hpp>
+
+#include <ranges>
+
+void memset_2d_cartesian_product_iota_for_each(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  ) noexcept
+{
+  // The last base varies fastest, so it's the contiguous one.
+  spaces::for_each(
+    spaces::cartesian_product(
+      std::views::iota(0LU, A.extent(1))
+    , std::views::iota(0LU, A.extent(0))
+    )
+  , [=] (auto j, auto i) { A(i, j) = 0.0; }
+  );
+}
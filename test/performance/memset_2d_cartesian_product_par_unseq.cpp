@@ -0,0 +1,33 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/cartesian_product.hpp>
+
+#include <ranges>
+
+#if defined(SPACES_HAS_PARALLEL_EXECUTION)
+  #include <spaces/parallel_for_each.hpp>
+#endif
+
+// Without a parallel algorithms backend, this runs sequentially.
+void memset_2d_cartesian_product_par_unseq(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  )
+{
+  spaces::for_each(
+    #if defined(SPACES_HAS_PARALLEL_EXECUTION)
+      std::execution::par_unseq,
+    #endif
+    spaces::cartesian_product(
+      std::views::iota(0LU, A.extent(1))
+    , std::views::iota(0LU, A.extent(0))
+    )
+  , [=] (auto j, auto i) { A(i, j) = 0.0; }
+  );
+}
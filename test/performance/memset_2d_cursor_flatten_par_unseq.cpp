@@ -0,0 +1,32 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/cursor.hpp>
+
+#include <algorithm>
+
+#if defined(SPACES_HAS_PARALLEL_EXECUTION)
+  #include <execution>
+#endif
+
+// Without a parallel algorithms backend, this runs sequentially.
+void memset_2d_cursor_flatten_par_unseq(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  )
+{
+  auto r = spaces::flatten(spaces::cursor<2>(A.extent(0), A.extent(1)));
+
+  std::for_each(
+    #if defined(SPACES_HAS_PARALLEL_EXECUTION)
+      std::execution::par_unseq,
+    #endif
+    r.begin(), r.end()
+  , [=] (auto pos) { A(pos[0], pos[1]) = 0.0; }
+  );
+}
@@ -0,0 +1,30 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/index_generator.hpp>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+void memset_2d_index_generator_arena(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  )
+{
+  alignas(std::max_align_t) std::byte buffer[1024];
+  spaces::index_generator_arena arena(buffer, sizeof(buffer));
+
+  std::array<std::array<spaces::index_type, 2>, 2> const bounds{{
+    {0, A.extent(0)}
+  , {0, A.extent(1)}
+  }};
+
+  for (auto pos : spaces::generate_indices(std::allocator_arg, arena, bounds))
+    A(pos[0], pos[1]) = 0.0;
+}
@@ -0,0 +1,28 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/aligned_accessor.hpp>
+#include <spaces/cursor.hpp>
+#include <spaces/for_each.hpp>
+
+void memset_2d_space_based_for_each_aligned(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A_
+  ) noexcept
+{
+  // The driver's arrays are page aligned and their columns are a multiple of
+  // 32 elements long, so every column starts on a 64-byte boundary and the
+  // inner loop is all aligned vector stores, with no remainder.
+  auto A = spaces::aligned_cast<64>(A_);
+  SPACES_ASSUME((A.extent(0) % 32) == 0);
+  spaces::for_each(
+    spaces::cursor<2>(A.extent(0), A.extent(1))
+  , [=] (auto i, auto j) { A(i, j) = 0.0; }
+  );
+}
@@ -0,0 +1,27 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/cursor.hpp>
+#include <spaces/on_extent.hpp>
+#include <spaces/for_each.hpp>
+
+#include <ranges>
+
+// `for_each` rewrites the `std::views::reverse`s into loops that count down.
+void memset_2d_space_based_for_each_reverse(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  ) noexcept
+{
+  spaces::for_each(
+    spaces::cursor<2>(A.extent(0), A.extent(1))
+  | spaces::on_extent<0>(std::views::reverse)
+  | spaces::on_extent<1>(std::views::reverse)
+  , [=] (auto i, auto j) { A(i, j) = 0.0; }
+  );
+}
@@ -8,12 +8,17 @@
 #include <spaces/config.hpp>
 #include <spaces/optimization_hints.hpp>
 #include <spaces/mdspan.hpp>
+#include <spaces/huge_page_allocator.hpp>
 #include <spaces/test.hpp>
+#include <spaces/benchmark.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <memory>
 #include <functional>
+#include <iostream>
+#include <vector>
 
 extern void memset_diagonal_2d_reference(
   double* __restrict__ A
@@ -29,6 +34,10 @@ extern void memset_diagonal_2d_for_each_filter_o(
   spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
   );
 
+extern void memset_diagonal_2d_for_each_filter_o_chain(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  );
+
 void set_to_initial_state(
   spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
 ) {
@@ -47,27 +56,73 @@ void validate_state(
     }
 }
 
-int main() {
-  constexpr spaces::index_type N = 128;
-  constexpr spaces::index_type M = 128;
+using memset_diagonal_2d_kernel =
+  void (*)(spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left>);
 
-  std::unique_ptr<double[]> data(
-    reinterpret_cast<double*>(std::aligned_alloc(32, N * M * sizeof(double)))
-  );
-  spaces::mdspan A(data.get(), spaces::layout_left::mapping{spaces::extents{N, M}});
+struct named_memset_diagonal_2d_kernel
+{
+  char const* name;
+  memset_diagonal_2d_kernel kernel;
+};
+
+named_memset_diagonal_2d_kernel const kernels[] = {
+  {"memset_diagonal_2d_reference",
+    [] (spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A)
+    { memset_diagonal_2d_reference(A.data_handle(), A.extent(0), A.extent(1)); }}
+, {"memset_diagonal_2d_for_each_filter",
+    memset_diagonal_2d_for_each_filter}
+, {"memset_diagonal_2d_for_each_filter_o",
+    memset_diagonal_2d_for_each_filter_o}
+, {"memset_diagonal_2d_for_each_filter_o_chain",
+    memset_diagonal_2d_for_each_filter_o_chain}
+};
+
+// `--sizes=N,...` runs the kernels on N x N arrays. N must be a multiple of
+// 32, as the reference kernel assumes. `--sweep` picks such N so that the
+// footprints double from the L1 cache to main memory.
+int main(int argc, char** argv) {
+  auto const options = spaces::parse_benchmark_options(argc, argv);
 
-  set_to_initial_state(A);
-  memset_diagonal_2d_reference(A.data_handle(), A.extent(0), A.extent(1));
-  validate_state(A);
+#if defined(SPACES_BENCHMARK)
+  std::vector<spaces::benchmark_result> results;
+#endif
 
-  set_to_initial_state(A);
-  memset_diagonal_2d_for_each_filter(A);
-  validate_state(A);
+  for (spaces::index_type N :
+       options.extents_for(2, sizeof(double), 32, 128)) {
+    if (N % 32 != 0) {
+      std::cerr << "error: size " << N << " is not a multiple of 32\n";
+      return 1;
+    }
+    spaces::index_type const M = N;
+
+    auto data = spaces::make_huge_page_mdarray<double>(
+      spaces::layout_left::mapping{spaces::extents{N, M}}
+    );
+    spaces::mdspan A = data.to_mdspan();
+
+    for (auto [name, kernel] : kernels) {
+      set_to_initial_state(A);
+      kernel(A);
+      validate_state(A);
+    }
+
+#if defined(SPACES_BENCHMARK)
+    spaces::benchmark_kernels(
+      results, kernels, {A.extent(0), A.extent(1)}
+    , std::min(A.extent(0), A.extent(1)) * sizeof(double)
+    , [&] { set_to_initial_state(A); }
+    , [&] (auto kernel) { kernel(A); }
+    , options
+    );
+#endif
+  }
 
-  set_to_initial_state(A);
-  memset_diagonal_2d_for_each_filter_o(A);
-  validate_state(A);
+#if defined(SPACES_BENCHMARK)
+  if (!spaces::report_benchmarks(
+        "memset_diagonal_2d", "memset_diagonal_2d_reference", results, options
+      ))
+    return 1;
+#endif
 
   return spaces::test_report_errors();
 }
-
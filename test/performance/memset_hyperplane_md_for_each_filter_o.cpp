@@ -0,0 +1,47 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/cursor.hpp>
+#include <spaces/on_extent.hpp>
+#include <spaces/for_each.hpp>
+#include <spaces/views.hpp>
+
+#include <utility>
+
+template <spaces::index_type R>
+void memset_hyperplane_md_for_each_filter_o(
+  spaces::mdspan<double, spaces::dextents<R>, spaces::layout_left> A
+  ) noexcept
+{
+  [=] <std::size_t... I> (std::index_sequence<I...>) {
+    spaces::for_each(
+      spaces::cursor<R>(A.extent(I)...)
+    | spaces::on_extent<R - 2>(
+        spaces::filter_o([] (auto i, auto j) { return i == j; })
+      )
+    , [=] (auto... i) { A(i...) = 0.0; }
+    );
+  }(std::make_index_sequence<R>{});
+}
+
+template void memset_hyperplane_md_for_each_filter_o<2>(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left>
+) noexcept;
+template void memset_hyperplane_md_for_each_filter_o<3>(
+  spaces::mdspan<double, spaces::dextents<3>, spaces::layout_left>
+) noexcept;
+template void memset_hyperplane_md_for_each_filter_o<4>(
+  spaces::mdspan<double, spaces::dextents<4>, spaces::layout_left>
+) noexcept;
+template void memset_hyperplane_md_for_each_filter_o<5>(
+  spaces::mdspan<double, spaces::dextents<5>, spaces::layout_left>
+) noexcept;
+template void memset_hyperplane_md_for_each_filter_o<6>(
+  spaces::mdspan<double, spaces::dextents<6>, spaces::layout_left>
+) noexcept;
@@ -0,0 +1,124 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/huge_page_allocator.hpp>
+#include <spaces/test.hpp>
+#include <spaces/benchmark.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <memory>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+extern void memset_interior_2d_reference(
+  double* __restrict__ A
+, spaces::index_type N
+, spaces::index_type M
+  ) noexcept;
+
+extern void memset_interior_2d_for_each_bounds(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  );
+
+extern void memset_interior_2d_for_each_views(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  );
+
+void set_to_initial_state(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+) {
+  for (spaces::index_type j = 0; j != A.extent(1); ++j)
+    for (spaces::index_type i = 0; i != A.extent(0); ++i)
+      A(i, j) = A.mapping()(i, j);
+}
+
+void validate_state(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+) {
+  for (spaces::index_type j = 0; j != A.extent(1); ++j)
+    for (spaces::index_type i = 0; i != A.extent(0); ++i) {
+      bool const interior
+        = i != 0 && i != A.extent(0) - 1 && j != 0 && j != A.extent(1) - 1;
+      if (interior) SPACES_TEST_EQ(A(i, j), 0.0);
+      else SPACES_TEST_EQ(A(i, j), A.mapping()(i, j));
+    }
+}
+
+using memset_interior_2d_kernel =
+  void (*)(spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left>);
+
+struct named_memset_interior_2d_kernel
+{
+  char const* name;
+  memset_interior_2d_kernel kernel;
+};
+
+named_memset_interior_2d_kernel const kernels[] = {
+  {"memset_interior_2d_reference",
+    [] (spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A)
+    { memset_interior_2d_reference(A.data_handle(), A.extent(0), A.extent(1)); }}
+, {"memset_interior_2d_for_each_bounds",
+    memset_interior_2d_for_each_bounds}
+, {"memset_interior_2d_for_each_views",
+    memset_interior_2d_for_each_views}
+};
+
+// `--sizes=N,...` runs the kernels on N x N arrays. N must be a multiple of
+// 32, as the reference kernel assumes. `--sweep` picks such N so that the
+// footprints double from the L1 cache to main memory.
+int main(int argc, char** argv) {
+  auto const options = spaces::parse_benchmark_options(argc, argv);
+
+#if defined(SPACES_BENCHMARK)
+  std::vector<spaces::benchmark_result> results;
+#endif
+
+  for (spaces::index_type N :
+       options.extents_for(2, sizeof(double), 32, 128)) {
+    if (N % 32 != 0) {
+      std::cerr << "error: size " << N << " is not a multiple of 32\n";
+      return 1;
+    }
+    spaces::index_type const M = N;
+
+    auto data = spaces::make_huge_page_mdarray<double>(
+      spaces::layout_left::mapping{spaces::extents{N, M}}
+    );
+    spaces::mdspan A = data.to_mdspan();
+
+    for (auto [name, kernel] : kernels) {
+      set_to_initial_state(A);
+      kernel(A);
+      validate_state(A);
+    }
+
+#if defined(SPACES_BENCHMARK)
+    spaces::benchmark_kernels(
+      results, kernels, {A.extent(0), A.extent(1)}
+    , (A.extent(0) - 2) * (A.extent(1) - 2) * sizeof(double)
+    , [&] { set_to_initial_state(A); }
+    , [&] (auto kernel) { kernel(A); }
+    , options
+    );
+#endif
+  }
+
+#if defined(SPACES_BENCHMARK)
+  if (!spaces::report_benchmarks(
+        "memset_interior_2d", "memset_interior_2d_reference", results, options
+      ))
+    return 1;
+#endif
+
+  return spaces::test_report_errors();
+}
@@ -0,0 +1,24 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/cursor.hpp>
+#include <spaces/extent_bounds.hpp>
+#include <spaces/for_each.hpp>
+
+void memset_interior_2d_for_each_bounds(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  ) noexcept
+{
+  spaces::for_each(
+    spaces::cursor<2>(A.extent(0), A.extent(1))
+  | spaces::drop<0>(1) | spaces::take<0>(A.extent(0) - 2)
+  | spaces::drop<1>(1) | spaces::take<1>(A.extent(1) - 2)
+  , [=] (auto i, auto j) { A(i, j) = 0.0; }
+  );
+}
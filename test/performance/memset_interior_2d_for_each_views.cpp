@@ -0,0 +1,32 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/cursor.hpp>
+#include <spaces/on_extent.hpp>
+#include <spaces/for_each.hpp>
+
+#include <ranges>
+
+// `for_each` rewrites the `std::views::drop`s and `std::views::take`s into
+// changes of the loop bounds.
+void memset_interior_2d_for_each_views(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left> A
+  ) noexcept
+{
+  spaces::for_each(
+    spaces::cursor<2>(A.extent(0), A.extent(1))
+  | spaces::on_extent<0>(
+      std::views::drop(1) | std::views::take(A.extent(0) - 2)
+    )
+  | spaces::on_extent<1>(
+      std::views::drop(1) | std::views::take(A.extent(1) - 2)
+    )
+  , [=] (auto i, auto j) { A(i, j) = 0.0; }
+  );
+}
@@ -0,0 +1,200 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Rank sweep of the memset kernels: for each rank from 1 to 6, zeroes a whole
+// array and the hyperplane of it where the last two indices are equal, with
+// both a hand-written loop nest and the spaces abstractions. Combined with
+// `--sweep`, this shows how the abstraction penalty changes with rank and with
+// the level of the memory hierarchy the array fits in.
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/huge_page_allocator.hpp>
+#include <spaces/test.hpp>
+#include <spaces/benchmark.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+template <spaces::index_type R>
+using memset_md_array
+  = spaces::mdspan<double, spaces::dextents<R>, spaces::layout_left>;
+
+template <spaces::index_type R>
+extern void memset_md_reference(
+  double* __restrict__ A
+, std::array<spaces::index_type, R> n
+  ) noexcept;
+
+template <spaces::index_type R>
+extern void memset_md_space_based_for_each(memset_md_array<R> A) noexcept;
+
+template <spaces::index_type R>
+extern void memset_md_index_generator(memset_md_array<R> A);
+
+template <spaces::index_type R>
+extern void memset_hyperplane_md_reference(
+  double* __restrict__ A
+, std::array<spaces::index_type, R> n
+  ) noexcept;
+
+template <spaces::index_type R>
+extern void memset_hyperplane_md_for_each_filter_o(
+  memset_md_array<R> A
+  ) noexcept;
+
+template <spaces::index_type R>
+std::array<spaces::index_type, R> extents_of(memset_md_array<R> A)
+{
+  std::array<spaces::index_type, R> n;
+  for (spaces::index_type d = 0; d != R; ++d) n[d] = A.extent(d);
+  return n;
+}
+
+// The arrays are contiguous, so they can be initialized and checked through
+// their offsets.
+template <spaces::index_type R>
+void set_to_initial_state(memset_md_array<R> A)
+{
+  for (spaces::index_type o = 0; o != A.size(); ++o)
+    A.data_handle()[o] = double(o);
+}
+
+template <spaces::index_type R>
+void validate_state(memset_md_array<R> A, bool hyperplane)
+{
+  spaces::index_type stride = 1;
+  for (spaces::index_type d = 0; R > 2 && d != R - 2; ++d)
+    stride *= A.extent(d);
+
+  for (spaces::index_type o = 0; o != A.size(); ++o) {
+    bool zeroed = true;
+    if (hyperplane) {
+      auto const i = (o / stride) % A.extent(R - 2);
+      auto const j = o / (stride * A.extent(R - 2));
+      zeroed = i == j;
+    }
+    if (zeroed) SPACES_TEST_EQ(A.data_handle()[o], 0.0);
+    else SPACES_TEST_EQ(A.data_handle()[o], double(o));
+  }
+}
+
+template <spaces::index_type R>
+struct named_memset_md_kernel
+{
+  std::string name;
+  void (*kernel)(memset_md_array<R>);
+};
+
+// Runs each family of rank `R` kernels on every problem size. The extents of
+// the arrays need not be multiples of anything, so sweeps stay close to the
+// requested footprints at high ranks.
+template <spaces::index_type R>
+void run_rank(
+  spaces::benchmark_options const& options
+, [[maybe_unused]] std::vector<spaces::benchmark_result>& results
+  )
+{
+  std::string const rank = std::to_string(R) + "d";
+
+  std::vector<named_memset_md_kernel<R>> const memset = {
+    {"memset_md_" + rank + "_reference",
+      [] (memset_md_array<R> A)
+      { memset_md_reference<R>(A.data_handle(), extents_of<R>(A)); }}
+  , {"memset_md_" + rank + "_space_based_for_each",
+      memset_md_space_based_for_each<R>}
+  , {"memset_md_" + rank + "_index_generator",
+      memset_md_index_generator<R>}
+  };
+
+  std::vector<named_memset_md_kernel<R>> hyperplane;
+  if constexpr (R >= 2)
+    hyperplane = {
+      {"memset_hyperplane_" + rank + "_reference",
+        [] (memset_md_array<R> A)
+        {
+          memset_hyperplane_md_reference<R>(
+            A.data_handle(), extents_of<R>(A)
+          );
+        }}
+    , {"memset_hyperplane_" + rank + "_for_each_filter_o",
+        memset_hyperplane_md_for_each_filter_o<R>}
+    };
+
+  constexpr spaces::index_type default_extent[] = {32768, 180, 32, 12, 8, 6};
+
+  for (spaces::index_type N :
+       options.extents_for(R, sizeof(double), 2, default_extent[R - 1])) {
+    std::array<spaces::index_type, R> n;
+    n.fill(N);
+
+    spaces::index_type size = 1;
+    for (auto e : n) size *= e;
+
+    std::vector<double, spaces::huge_page_allocator<double>> data(size);
+    memset_md_array<R> A(data.data(), n);
+
+    for (auto const& [name, kernel] : memset) {
+      set_to_initial_state<R>(A);
+      kernel(A);
+      validate_state<R>(A, false);
+    }
+    for (auto const& [name, kernel] : hyperplane) {
+      set_to_initial_state<R>(A);
+      kernel(A);
+      validate_state<R>(A, true);
+    }
+
+#if defined(SPACES_BENCHMARK)
+    std::vector<spaces::index_type> const extents(n.begin(), n.end());
+
+    auto const bench = [&] (auto const& kernels, std::uint64_t bytes)
+    {
+      auto const first = results.size();
+      spaces::benchmark_kernels(
+        results, kernels, extents, bytes
+      , [&] { set_to_initial_state<R>(A); }
+      , [&] (auto kernel) { kernel(A); }
+      , options
+      );
+      for (auto r = first; r != results.size(); ++r)
+        results[r].reference = kernels.front().name;
+    };
+
+    bench(memset, size * sizeof(double));
+    if (!hyperplane.empty())
+      bench(hyperplane, size / N * sizeof(double));
+#endif
+  }
+}
+
+// `--sizes=N,...` runs the kernels on arrays with every extent equal to N;
+// `--sweep` picks N for each rank so that the footprints double from the L1
+// cache to main memory.
+int main(int argc, char** argv) {
+  auto const options = spaces::parse_benchmark_options(argc, argv);
+
+  std::vector<spaces::benchmark_result> results;
+
+  [&] <spaces::index_type... R>
+      (std::integer_sequence<spaces::index_type, R...>) {
+    (run_rank<R + 1>(options, results), ...);
+  }(std::make_integer_sequence<spaces::index_type, 6>{});
+
+#if defined(SPACES_BENCHMARK)
+  if (!spaces::report_benchmarks("memset_md", "", results, options))
+    return 1;
+#endif
+
+  return spaces::test_report_errors();
+}
@@ -0,0 +1,44 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/index_generator.hpp>
+
+#include <array>
+
+template <spaces::index_type R>
+void memset_md_index_generator(
+  spaces::mdspan<double, spaces::dextents<R>, spaces::layout_left> A
+  )
+{
+  std::array<std::array<spaces::index_type, 2>, R> bounds;
+  for (spaces::index_type d = 0; d != R; ++d)
+    bounds[d] = {0, A.extent(d)};
+
+  for (auto pos : spaces::generate_indices(bounds))
+    A[pos] = 0.0;
+}
+
+template void memset_md_index_generator<1>(
+  spaces::mdspan<double, spaces::dextents<1>, spaces::layout_left>
+);
+template void memset_md_index_generator<2>(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left>
+);
+template void memset_md_index_generator<3>(
+  spaces::mdspan<double, spaces::dextents<3>, spaces::layout_left>
+);
+template void memset_md_index_generator<4>(
+  spaces::mdspan<double, spaces::dextents<4>, spaces::layout_left>
+);
+template void memset_md_index_generator<5>(
+  spaces::mdspan<double, spaces::dextents<5>, spaces::layout_left>
+);
+template void memset_md_index_generator<6>(
+  spaces::mdspan<double, spaces::dextents<6>, spaces::layout_left>
+);
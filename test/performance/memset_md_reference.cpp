@@ -0,0 +1,108 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/optimization_hints.hpp>
+
+#include <algorithm>
+#include <array>
+
+inline void memset_md_reference_row(
+  double* __restrict__ A
+, spaces::index_type   N
+  ) noexcept
+{
+  SPACES_DEMAND_VECTORIZATION
+  for (spaces::index_type i = 0; i != N; ++i)
+    A[i] = 0.0;
+}
+
+// Zeroes the dimensions `0, ..., D` of the layout left array `A`.
+template <spaces::index_type D, spaces::index_type R>
+inline void memset_md_reference_loop(
+  double* __restrict__ A
+, std::array<spaces::index_type, R> const& n
+  ) noexcept
+{
+  if constexpr (D == 0) {
+    memset_md_reference_row(A, n[0]);
+  } else {
+    spaces::index_type stride = 1;
+    for (spaces::index_type d = 0; d != D; ++d)
+      stride *= n[d];
+
+    for (spaces::index_type i = 0; i != n[D]; ++i)
+      memset_md_reference_loop<D - 1, R>(A + i * stride, n);
+  }
+}
+
+template <spaces::index_type R>
+void memset_md_reference(
+  double* __restrict__ A
+, std::array<spaces::index_type, R> n
+  ) noexcept
+{
+  SPACES_ASSUME_ALIGNED(A, 32);
+
+  memset_md_reference_loop<R - 1, R>(A, n);
+}
+
+template void memset_md_reference<1>(
+  double*, std::array<spaces::index_type, 1>
+) noexcept;
+template void memset_md_reference<2>(
+  double*, std::array<spaces::index_type, 2>
+) noexcept;
+template void memset_md_reference<3>(
+  double*, std::array<spaces::index_type, 3>
+) noexcept;
+template void memset_md_reference<4>(
+  double*, std::array<spaces::index_type, 4>
+) noexcept;
+template void memset_md_reference<5>(
+  double*, std::array<spaces::index_type, 5>
+) noexcept;
+template void memset_md_reference<6>(
+  double*, std::array<spaces::index_type, 6>
+) noexcept;
+
+// Zeroes the elements of the layout left array `A` whose last two indices are
+// equal.
+template <spaces::index_type R>
+void memset_hyperplane_md_reference(
+  double* __restrict__ A
+, std::array<spaces::index_type, R> n
+  ) noexcept
+{
+  SPACES_ASSUME_ALIGNED(A, 32);
+
+  spaces::index_type stride = 1;
+  for (spaces::index_type d = 0; d != R - 2; ++d)
+    stride *= n[d];
+
+  spaces::index_type const diagonal = stride * (1 + n[R - 2]);
+
+  for (spaces::index_type k = 0; k != std::min(n[R - 2], n[R - 1]); ++k)
+    if constexpr (R == 2) A[k * diagonal] = 0.0;
+    else memset_md_reference_loop<R - 3, R>(A + k * diagonal, n);
+}
+
+template void memset_hyperplane_md_reference<2>(
+  double*, std::array<spaces::index_type, 2>
+) noexcept;
+template void memset_hyperplane_md_reference<3>(
+  double*, std::array<spaces::index_type, 3>
+) noexcept;
+template void memset_hyperplane_md_reference<4>(
+  double*, std::array<spaces::index_type, 4>
+) noexcept;
+template void memset_hyperplane_md_reference<5>(
+  double*, std::array<spaces::index_type, 5>
+) noexcept;
+template void memset_hyperplane_md_reference<6>(
+  double*, std::array<spaces::index_type, 6>
+) noexcept;
@@ -0,0 +1,45 @@
+// Copyright (c) 2015-2017 Bryce Adelstein Lelbach
+// Copyright (c) 2017-2023 NVIDIA Corporation
+//
+// Distributed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <spaces/config.hpp>
+#include <spaces/mdspan.hpp>
+#include <spaces/cursor.hpp>
+#include <spaces/for_each.hpp>
+
+#include <utility>
+
+template <spaces::index_type R>
+void memset_md_space_based_for_each(
+  spaces::mdspan<double, spaces::dextents<R>, spaces::layout_left> A
+  ) noexcept
+{
+  [=] <std::size_t... I> (std::index_sequence<I...>) {
+    spaces::for_each(
+      spaces::cursor<R>(A.extent(I)...)
+    , [=] (auto... i) { A(i...) = 0.0; }
+    );
+  }(std::make_index_sequence<R>{});
+}
+
+template void memset_md_space_based_for_each<1>(
+  spaces::mdspan<double, spaces::dextents<1>, spaces::layout_left>
+) noexcept;
+template void memset_md_space_based_for_each<2>(
+  spaces::mdspan<double, spaces::dextents<2>, spaces::layout_left>
+) noexcept;
+template void memset_md_space_based_for_each<3>(
+  spaces::mdspan<double, spaces::dextents<3>, spaces::layout_left>
+) noexcept;
+template void memset_md_space_based_for_each<4>(
+  spaces::mdspan<double, spaces::dextents<4>, spaces::layout_left>
+) noexcept;
+template void memset_md_space_based_for_each<5>(
+  spaces::mdspan<double, spaces::dextents<5>, spaces::layout_left>
+) noexcept;
+template void memset_md_space_based_for_each<6>(
+  spaces::mdspan<double, spaces::dextents<6>, spaces::layout_left>
+) noexcept;
@@ -8,12 +8,17 @@
 #include <spaces/config.hpp>
 #include <spaces/optimization_hints.hpp>
 #include <spaces/mdspan.hpp>
+#include <spaces/huge_page_allocator.hpp>
 #include <spaces/test.hpp>
+#include <spaces/benchmark.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <memory>
 #include <functional>
+#include <iostream>
+#include <vector>
 
 extern void memset_plane_3d_reference(
   double* __restrict__ A
@@ -50,32 +55,77 @@ void validate_state(
       }
 }
 
-int main() {
-  constexpr spaces::index_type N = 64;
-  constexpr spaces::index_type M = 64;
-  constexpr spaces::index_type O = 64;
+using memset_plane_3d_kernel =
+  void (*)(spaces::mdspan<double, spaces::dextents<3>, spaces::layout_left>);
 
-  std::unique_ptr<double[]> data(
-    reinterpret_cast<double*>(std::aligned_alloc(32, N * M * O * sizeof(double)))
-  );
-  spaces::mdspan A(
-    data.get(), spaces::layout_left::mapping{spaces::extents{N, M, O}}
-  );
+struct named_memset_plane_3d_kernel
+{
+  char const* name;
+  memset_plane_3d_kernel kernel;
+};
 
-  set_to_initial_state(A);
-  memset_plane_3d_reference(
-    A.data_handle(), A.extent(0), A.extent(1), A.extent(2)
-  );
-  validate_state(A);
+named_memset_plane_3d_kernel const kernels[] = {
+  {"memset_plane_3d_reference",
+    [] (spaces::mdspan<double, spaces::dextents<3>, spaces::layout_left> A)
+    {
+      memset_plane_3d_reference(
+        A.data_handle(), A.extent(0), A.extent(1), A.extent(2)
+      );
+    }}
+, {"memset_plane_3d_for_each_filter",
+    memset_plane_3d_for_each_filter}
+, {"memset_plane_3d_for_each_filter_o",
+    memset_plane_3d_for_each_filter_o}
+};
+
+// `--sizes=N,...` runs the kernels on N x N x N arrays. N must be a multiple of
+// 32, as the reference kernel assumes. `--sweep` picks such N so that the
+// footprints double from the L1 cache to main memory.
+int main(int argc, char** argv) {
+  auto const options = spaces::parse_benchmark_options(argc, argv);
+
+#if defined(SPACES_BENCHMARK)
+  std::vector<spaces::benchmark_result> results;
+#endif
 
-  set_to_initial_state(A);
-  memset_plane_3d_for_each_filter(A);
-  validate_state(A);
+  for (spaces::index_type N :
+       options.extents_for(3, sizeof(double), 32, 64)) {
+    if (N % 32 != 0) {
+      std::cerr << "error: size " << N << " is not a multiple of 32\n";
+      return 1;
+    }
+    spaces::index_type const M = N;
+    spaces::index_type const O = N;
 
-  set_to_initial_state(A);
-  memset_plane_3d_for_each_filter_o(A);
-  validate_state(A);
+    auto data = spaces::make_huge_page_mdarray<double>(
+      spaces::layout_left::mapping{spaces::extents{N, M, O}}
+    );
+    spaces::mdspan A = data.to_mdspan();
+
+    for (auto [name, kernel] : kernels) {
+      set_to_initial_state(A);
+      kernel(A);
+      validate_state(A);
+    }
+
+#if defined(SPACES_BENCHMARK)
+    spaces::benchmark_kernels(
+      results, kernels, {A.extent(0), A.extent(1), A.extent(2)}
+    , std::min(A.extent(1), A.extent(2)) * A.extent(0)
+      * sizeof(double)
+    , [&] { set_to_initial_state(A); }
+    , [&] (auto kernel) { kernel(A); }
+    , options
+    );
+#endif
+  }
+
+#if defined(SPACES_BENCHMARK)
+  if (!spaces::report_benchmarks(
+        "memset_plane_3d", "memset_plane_3d_reference", results, options
+      ))
+    return 1;
+#endif
 
   return spaces::test_report_errors();
 }
-